@@ -0,0 +1,167 @@
+# Generates src/glyphatlas.cpp: the large text sizes of the 5x7 GFX font, pre-rasterized
+# Letters and symbols are smoothed, size 2 with Scale2x and size 3 with Scale3x, so diagonals and curves
+# get in-between steps instead of square blocks. Digits and the decimal separators are scaled nearest
+# neighbour (pixel-identical to GFX): the smoothing detaches pixels of the thin 5x7 digit strokes.
+# The cells keep the GFX geometry (6 x 8 times size).
+#
+# usage: python3 glyphatlas.py
+
+import os
+
+# 5 columns per glyph, bit 0 = top row (classic GFX font layout)
+FONT = {
+    ' ': [0x00, 0x00, 0x00, 0x00, 0x00],
+    '%': [0x23, 0x13, 0x08, 0x64, 0x62],
+    '+': [0x08, 0x08, 0x3E, 0x08, 0x08],
+    ',': [0x00, 0x80, 0x70, 0x30, 0x00],
+    '-': [0x08, 0x08, 0x08, 0x08, 0x08],
+    '.': [0x00, 0x00, 0x60, 0x60, 0x00],
+    '/': [0x20, 0x10, 0x08, 0x04, 0x02],
+    '0': [0x3E, 0x51, 0x49, 0x45, 0x3E],
+    '1': [0x00, 0x42, 0x7F, 0x40, 0x00],
+    '2': [0x72, 0x49, 0x49, 0x49, 0x46],
+    '3': [0x21, 0x41, 0x49, 0x4D, 0x33],
+    '4': [0x18, 0x14, 0x12, 0x7F, 0x10],
+    '5': [0x27, 0x45, 0x45, 0x45, 0x39],
+    '6': [0x3C, 0x4A, 0x49, 0x49, 0x31],
+    '7': [0x41, 0x21, 0x11, 0x09, 0x07],
+    '8': [0x36, 0x49, 0x49, 0x49, 0x36],
+    '9': [0x46, 0x49, 0x49, 0x29, 0x1E],
+    ':': [0x00, 0x00, 0x14, 0x00, 0x00],
+    '=': [0x14, 0x14, 0x14, 0x14, 0x14],
+    'A': [0x7C, 0x12, 0x11, 0x12, 0x7C],
+    'B': [0x7F, 0x49, 0x49, 0x49, 0x36],
+    'C': [0x3E, 0x41, 0x41, 0x41, 0x22],
+    'D': [0x7F, 0x41, 0x41, 0x41, 0x3E],
+    'E': [0x7F, 0x49, 0x49, 0x49, 0x41],
+    'F': [0x7F, 0x09, 0x09, 0x09, 0x01],
+    'G': [0x3E, 0x41, 0x41, 0x51, 0x73],
+    'H': [0x7F, 0x08, 0x08, 0x08, 0x7F],
+    'I': [0x00, 0x41, 0x7F, 0x41, 0x00],
+    'J': [0x20, 0x40, 0x41, 0x3F, 0x01],
+    'K': [0x7F, 0x08, 0x14, 0x22, 0x41],
+    'L': [0x7F, 0x40, 0x40, 0x40, 0x40],
+    'M': [0x7F, 0x02, 0x1C, 0x02, 0x7F],
+    'N': [0x7F, 0x04, 0x08, 0x10, 0x7F],
+    'O': [0x3E, 0x41, 0x41, 0x41, 0x3E],
+    'P': [0x7F, 0x09, 0x09, 0x09, 0x06],
+    'Q': [0x3E, 0x41, 0x51, 0x21, 0x5E],
+    'R': [0x7F, 0x09, 0x19, 0x29, 0x46],
+    'S': [0x26, 0x49, 0x49, 0x49, 0x32],
+    'T': [0x03, 0x01, 0x7F, 0x01, 0x03],
+    'U': [0x3F, 0x40, 0x40, 0x40, 0x3F],
+    'V': [0x1F, 0x20, 0x40, 0x20, 0x1F],
+    'W': [0x3F, 0x40, 0x38, 0x40, 0x3F],
+    'X': [0x63, 0x14, 0x08, 0x14, 0x63],
+    'Y': [0x03, 0x04, 0x78, 0x04, 0x03],
+    'Z': [0x61, 0x59, 0x49, 0x4D, 0x43],
+}
+
+CELL_W, CELL_H = 6, 8
+
+# price text, kept unsmoothed
+NEAREST = set("0123456789.,")
+
+
+def bitmap(columns):
+    # 6 x 8 cell, the 6th column is the character spacing
+    return [[(columns[x] >> y) & 1 if x < 5 else 0 for x in range(CELL_W)] for y in range(CELL_H)]
+
+
+def pixel(img, x, y):
+    if 0 <= y < len(img) and 0 <= x < len(img[0]):
+        return img[y][x]
+    return 0
+
+
+def scale2x(img):
+    h, w = len(img), len(img[0])
+    out = [[0] * (w * 2) for _ in range(h * 2)]
+    for y in range(h):
+        for x in range(w):
+            a, b = pixel(img, x, y - 1), pixel(img, x + 1, y)
+            c, d = pixel(img, x - 1, y), pixel(img, x, y + 1)
+            p = img[y][x]
+            out[2 * y][2 * x] = a if (c == a and c != d and a != b) else p
+            out[2 * y][2 * x + 1] = b if (a == b and a != c and b != d) else p
+            out[2 * y + 1][2 * x] = c if (d == c and d != b and c != a) else p
+            out[2 * y + 1][2 * x + 1] = d if (b == d and b != a and d != c) else p
+    return out
+
+
+def scale3x(img):
+    h, w = len(img), len(img[0])
+    out = [[0] * (w * 3) for _ in range(h * 3)]
+    for y in range(h):
+        for x in range(w):
+            a, b, c = pixel(img, x - 1, y - 1), pixel(img, x, y - 1), pixel(img, x + 1, y - 1)
+            d, e, f = pixel(img, x - 1, y), img[y][x], pixel(img, x + 1, y)
+            g, hh, i = pixel(img, x - 1, y + 1), pixel(img, x, y + 1), pixel(img, x + 1, y + 1)
+            if b != hh and d != f:
+                e0 = d if d == b else e
+                e1 = b if (d == b and e != c) or (b == f and e != a) else e
+                e2 = f if b == f else e
+                e3 = d if (d == b and e != g) or (d == hh and e != a) else e
+                e5 = f if (b == f and e != i) or (hh == f and e != c) else e
+                e6 = d if d == hh else e
+                e7 = hh if (d == hh and e != i) or (hh == f and e != g) else e
+                e8 = f if hh == f else e
+            else:
+                e0 = e1 = e2 = e3 = e5 = e6 = e7 = e8 = e
+            block = [[e0, e1, e2], [e3, e, e5], [e6, e7, e8]]
+            for dy in range(3):
+                for dx in range(3):
+                    out[3 * y + dy][3 * x + dx] = block[dy][dx]
+    return out
+
+
+def nearest(img, factor):
+    return [[px for px in row for _ in range(factor)] for row in img for _ in range(factor)]
+
+
+def rows(img):
+    # one word per row, the leftmost pixel is the highest bit
+    return [sum(bit << (len(row) - 1 - x) for x, bit in enumerate(row)) for row in img]
+
+
+def emit(name, chars, scaler, factor):
+    lines = [f"const uint32_t {name}[GLYPH_COUNT][{CELL_H * factor}] = {{"]
+    for ch in chars:
+        img = bitmap(FONT[ch])
+        img = nearest(img, factor) if ch in NEAREST else scaler(img)
+        data = ", ".join(f"0x{r:05X}" for r in rows(img))
+        lines.append(f"    {{ {data} }},  // '{ch}'")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    chars = sorted(FONT)
+    index = [-1] * 128
+    for n, ch in enumerate(chars):
+        index[ord(ch)] = n
+
+    out = [
+        "// Generated by glyphatlas.py, do not edit",
+        '#include "glyphatlas.h"',
+        "",
+        f'// "{"".join(chars)}"',
+        "const int8_t glyph_index[128] = {",
+    ]
+    for start in range(0, 128, 16):
+        out.append("    " + ", ".join(f"{v:2d}" for v in index[start:start + 16]) + ",")
+    out.append("};")
+    out.append("")
+    out.append(emit("glyphs_2", chars, scale2x, 2))
+    out.append("")
+    out.append(emit("glyphs_3", chars, scale3x, 3))
+    out.append("")
+
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "src", "glyphatlas.cpp")
+    with open(path, "w") as f:
+        f.write("\n".join(out))
+    print(f"{path}: {len(chars)} glyphs")
+
+
+if __name__ == "__main__":
+    main()
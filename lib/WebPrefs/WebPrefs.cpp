@@ -32,6 +32,14 @@ void WebPrefs::start() {
         server->on("/getJson", HTTP_GET|HTTP_POST, std::bind(&WebPrefs::onDataRequest, this, std::placeholders::_1));
         server->on("/done", HTTP_GET, std::bind(&WebPrefs::onDone, this, std::placeholders::_1));
         server->on("/", HTTP_GET, std::bind(&WebPrefs::onIndex, this, std::placeholders::_1));
+        for (const route &r : routes) {
+            ArRequestHandlerFunction handler = r.handler;
+            server->on(r.uri, HTTP_GET, [this, handler](AsyncWebServerRequest *request) {
+                if (!checkCredentials(request))
+                    return;
+                handler(request);
+            });
+        }
         server->onNotFound(std::bind(&WebPrefs::notFound, this, std::placeholders::_1));
         server->begin();
         is_running = true;
@@ -131,6 +139,11 @@ void WebPrefs::setAuthentication(const bool auth, const char *_user, const char
     is_auth = auth;
 }
 
+// registers an additional GET route (e.g. status pages), served with the same credentials as the settings
+void WebPrefs::on(const char *uri, ArRequestHandlerFunction handler) {
+    routes.push_back({uri, handler});
+}
+
 void WebPrefs::resetIdleTime() {
     last_activity = millis();
 }
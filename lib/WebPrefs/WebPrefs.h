@@ -56,6 +56,7 @@ class WebPrefs {
     void onDone(AsyncWebServerRequest *request);
     void notFound(AsyncWebServerRequest *request);
     void setAuthentication(const bool auth, const char *_user = "admin", const char *_password = "");
+    void on(const char *uri, ArRequestHandlerFunction handler);
     String url_encode(const String &str) const;
     String url_decode(const String &str, bool decode_plus = false) const;
     unsigned long getIdleTime() const;
@@ -69,12 +70,18 @@ class WebPrefs {
     void setValue(const String &value, int index) const;
     String getValue(int index) const;
     
+    struct route {
+        const char *uri;
+        ArRequestHandlerFunction handler;
+    };
+
     struct ChunkState {
         size_t index = 0;
         size_t offset = 0;
     };
 
     std::vector<input_field> fields;
+    std::vector<route> routes;
     const char *user;
     const char *password;
     void *prefs;
@@ -0,0 +1,363 @@
+#include "globals.h"
+#include "display.h"
+#include "alerts.h"
+
+static AlertRule rules[ALERT_MAX];
+static int num_rules = 0;
+
+// Levels sorted by value per asset, asset a owns [start[a], start[a + 1]) (render task only)
+static AlertLevel<Price> price_levels[ALERT_MAX];
+static uint8_t price_start[MAX_ASSETS + 1];
+static AlertLevel<float> move_levels[ALERT_LEVELS];
+static uint8_t move_start[MAX_ASSETS + 1];
+
+// Fired levels by index, in the segment of their asset: rising ones from its start upwards, falling ones
+// from its end downwards, each stack sorted so that the next level to re-arm is on top
+static uint8_t price_disarmed[ALERT_MAX];
+static DisarmedCount price_disarmed_count[MAX_ASSETS];
+static uint8_t move_disarmed[ALERT_LEVELS];
+static DisarmedCount move_disarmed_count[MAX_ASSETS];
+
+// values of the previous check, crossings are detected between them and the current values
+static Price last_price[MAX_ASSETS];
+static float last_change[MAX_ASSETS];
+static bool armed[MAX_ASSETS];
+static bool move_armed[MAX_ASSETS];     // the change only counts once the history covers its window
+
+// render task -> web server
+static AlertEvent events[ALERT_EVENTS];
+static uint32_t event_count = 0;
+static SemaphoreHandle_t events_mutex = nullptr;
+
+// ====================================================================================================
+// Sorted levels ======================================================================================
+// ====================================================================================================
+/**
+ * Inserts a level into the sorted segment [first, count) of the current asset
+ *
+ * @return new number of levels
+ */
+template <typename T>
+static int insertLevel(AlertLevel<T> *levels, int count, int first, T value, T band, uint8_t rule, bool rising) {
+    int i = count;
+    for (; i > first && levels[i - 1].value > value; i--) {
+        levels[i] = levels[i - 1];
+    }
+    levels[i] = { value, rising ? value - band : value + band, rule, rising, true };
+    return count + 1;
+}
+
+/**
+ * Binary search in a sorted segment
+ *
+ * @param upper false: first level >= value, true: first level > value
+ */
+template <typename T>
+static int findLevel(const AlertLevel<T> *levels, int first, int last, T value, bool upper) {
+    while (first < last) {
+        int mid = (first + last) / 2;
+        if (levels[mid].value < value || (upper && levels[mid].value == value)) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+static void fireAlert(uint8_t rule, int asset) {
+    const AssetData &data = assets[asset];
+    char text[PRICE_TEXT_SIZE];
+    formatPrice(text, sizeof(text), data.current_price, data.digits, '\0');
+    LOG_SINFO("Alert %s: %s %s (%+.2f%%)", rules[rule].text, data.asset_name, text, data.change_percent);
+
+    xSemaphoreTake(events_mutex, portMAX_DELAY);
+    AlertEvent &event = events[event_count % ALERT_EVENTS];
+    event.id = ++event_count;
+    event.time = time(nullptr);
+    event.rule = rule;
+    event.price = data.current_price;
+    event.change = data.change_percent;
+    xSemaphoreGive(events_mutex);
+}
+
+/**
+ * Disarms a fired level and pushes it onto the disarmed stack of its direction, sorted by re-arm value
+ * Rising levels re-arm from the highest re-arm value down, falling ones from the lowest up.
+ */
+template <typename T>
+static void disarmLevel(AlertLevel<T> *levels, uint8_t *disarmed, DisarmedCount &count, int first, int last,
+                        int index) {
+    AlertLevel<T> &level = levels[index];
+    level.armed = false;
+    if (level.rising) {
+        int i = first + count.rising++;
+        for (; i > first && levels[disarmed[i - 1]].rearm > level.rearm; i--) {
+            disarmed[i] = disarmed[i - 1];
+        }
+        disarmed[i] = index;
+    } else {
+        int i = last - 1 - count.falling++;
+        for (; i < last - 1 && levels[disarmed[i + 1]].rearm < level.rearm; i++) {
+            disarmed[i] = disarmed[i + 1];
+        }
+        disarmed[i] = index;
+    }
+}
+
+/**
+ * Re-arms the fired levels the value has moved back from by the deadband, only the tops of the
+ * disarmed stacks are visited
+ */
+template <typename T>
+static void rearmLevels(AlertLevel<T> *levels, const uint8_t *disarmed, DisarmedCount &count, int first, int last,
+                        T current) {
+    while (count.rising > 0 && current <= levels[disarmed[first + count.rising - 1]].rearm) {
+        levels[disarmed[first + --count.rising]].armed = true;
+    }
+    while (count.falling > 0 && current >= levels[disarmed[last - count.falling]].rearm) {
+        levels[disarmed[last - count.falling--]].armed = true;
+    }
+}
+
+/**
+ * Fires the armed levels crossed between the previous and the current value
+ * Two binary searches bound the crossed range, only levels inside it and the next levels to re-arm are
+ * visited.
+ *
+ * @return number of fired alerts
+ */
+template <typename T>
+static int checkLevels(AlertLevel<T> *levels, uint8_t *disarmed, DisarmedCount &count, int first, int last,
+                       T previous, T current, int asset) {
+    rearmLevels(levels, disarmed, count, first, last, current);
+
+    int from, to;
+    bool rising = current > previous;
+    if (rising) {
+        // previous < level <= current
+        from = findLevel(levels, first, last, previous, true);
+        to = findLevel(levels, from, last, current, true);
+    } else if (current < previous) {
+        // current <= level < previous
+        from = findLevel(levels, first, last, current, false);
+        to = findLevel(levels, from, last, previous, false);
+    } else {
+        return 0;
+    }
+
+    int fired = 0;
+    for (int i = from; i < to; i++) {
+        if (levels[i].rising == rising && levels[i].armed) {
+            disarmLevel(levels, disarmed, count, first, last, i);
+            fireAlert(levels[i].rule, asset);
+            fired++;
+        }
+    }
+    return fired;
+}
+
+// ====================================================================================================
+// Alert rules ========================================================================================
+// ====================================================================================================
+/**
+ * Parses the alert list, e.g. "BTC>110000,BTC<90000,ETH%5" (asset name or symbol, case-insensitive)
+ * > and < fire when the price crosses the threshold, % when the change of the history window
+ * reaches +/- the given percent.
+ */
+static void parseAlertList() {
+    char list[sizeof(dc.alert_list)];
+    strlcpy(list, dc.alert_list, sizeof(list));
+
+    num_rules = 0;
+    char *save = nullptr;
+    for (char *token = strtok_r(list, ", ", &save); token != nullptr; token = strtok_r(nullptr, ", ", &save)) {
+        if (num_rules >= ALERT_MAX) {
+            LOG_SERROR("Too many alerts (max. %d)", ALERT_MAX);
+            break;
+        }
+        AlertRule &rule = rules[num_rules];
+        strlcpy(rule.text, token, sizeof(rule.text));
+
+        char *op = strpbrk(token, "<>%");
+        if (op == nullptr || op == token) {
+            LOG_SERROR("Invalid alert: %s", rule.text);
+            continue;
+        }
+        char type = *op;
+        *op = '\0';
+
+        int asset = -1;
+        for (int i = 0; i < num_assets && asset < 0; i++) {
+            if (strcasecmp(token, assets[i].asset_name) == 0 || strcasecmp(token, assets[i].symbol) == 0) {
+                asset = i;
+            }
+        }
+        if (asset < 0) {
+            LOG_SERROR("Alert %s: unknown asset %s", rule.text, token);
+            continue;
+        }
+        rule.asset = asset;
+
+        if (type == '%') {
+            char *end;
+            rule.percent = strtof(op + 1, &end);
+            if (end == op + 1 || *end != '\0' || rule.percent <= 0.0f) {
+                LOG_SERROR("Invalid alert: %s", rule.text);
+                continue;
+            }
+            rule.type = ALERT_MOVE;
+        } else {
+            if (!parseDecimalPrice(op + 1, rule.price) || rule.price <= 0) {
+                LOG_SERROR("Invalid alert: %s", rule.text);
+                continue;
+            }
+            rule.type = (type == '>') ? ALERT_ABOVE : ALERT_BELOW;
+        }
+        num_rules++;
+    }
+}
+
+/**
+ * Builds the sorted level lists of all assets from the rules
+ */
+static void buildLevels() {
+    int price_count = 0;
+    int move_count = 0;
+    for (int a = 0; a < num_assets; a++) {
+        price_start[a] = price_count;
+        move_start[a] = move_count;
+        price_disarmed_count[a] = {};
+        move_disarmed_count[a] = {};
+        for (int r = 0; r < num_rules; r++) {
+            const AlertRule &rule = rules[r];
+            if (rule.asset != a) {
+                continue;
+            }
+            if (rule.type == ALERT_MOVE) {
+                move_count = insertLevel(move_levels, move_count, move_start[a], rule.percent, ALERT_MOVE_DEADBAND,
+                                         r, true);
+                move_count = insertLevel(move_levels, move_count, move_start[a], -rule.percent, ALERT_MOVE_DEADBAND,
+                                         r, false);
+            } else {
+                price_count = insertLevel(price_levels, price_count, price_start[a], rule.price,
+                                          rule.price / 10000 * ALERT_DEADBAND, r, rule.type == ALERT_ABOVE);
+            }
+        }
+    }
+    price_start[num_assets] = price_count;
+    move_start[num_assets] = move_count;
+}
+
+/**
+ * Checks the alert rules against the current prices and changes (render task only)
+ * Call after every price update. The first valid price of an asset only arms its price rules, the move
+ * rules are armed once the history covers its window, so a backfill or replay filling it does not fire.
+ * A fired level fires again only after the value moved back by the deadband.
+ *
+ * @return asset of the last fired alert, -1 if none fired
+ */
+int checkAlerts() {
+    int fired_asset = -1;
+    for (int i = 0; i < num_assets; i++) {
+        if (price_start[i] == price_start[i + 1] && move_start[i] == move_start[i + 1]) {
+            continue;
+        }
+        Price price = assets[i].current_price;
+        float change = assets[i].change_percent;
+        if (price <= 0) {
+            continue;
+        }
+
+        int fired = 0;
+        if (armed[i]) {
+            fired += checkLevels(price_levels, price_disarmed, price_disarmed_count[i], price_start[i],
+                                 price_start[i + 1], last_price[i], price, i);
+        }
+        if (move_armed[i]) {
+            fired += checkLevels(move_levels, move_disarmed, move_disarmed_count[i], move_start[i],
+                                 move_start[i + 1], last_change[i], change, i);
+        }
+        if (fired > 0) {
+            fired_asset = i;
+        }
+        const PriceHistory &history = *assets[i].history;
+        move_armed[i] = history.size() >= history.span();
+        armed[i] = true;
+        last_price[i] = price;
+        last_change[i] = change;
+    }
+    return fired_asset;
+}
+
+// ====================================================================================================
+// Web interface ======================================================================================
+// ====================================================================================================
+/**
+ * Writes a configured text as JSON string, quotes, backslashes and control characters escaped
+ */
+static void printJsonString(Print &out, const char *text) {
+    out.print('"');
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            out.print('\\');
+            out.print(*c);
+        } else if ((uint8_t)*c < 0x20) {
+            out.printf("\\u%04x", *c);
+        } else {
+            out.print(*c);
+        }
+    }
+    out.print('"');
+}
+
+/**
+ * Writes the rules and the fired alerts newer than since as JSON
+ * {"rules":["BTC>110000",..],"events":[{"id":..,"time":..,"rule":"BTC>110000","asset":"BTC","price":"..","change":..}]}
+ */
+static void writeAlertsJson(Print &out, uint32_t since) {
+    out.print("{\"rules\":[");
+    for (int r = 0; r < num_rules; r++) {
+        out.print((r > 0) ? "," : "");
+        printJsonString(out, rules[r].text);
+    }
+    out.print("],\"events\":[");
+
+    xSemaphoreTake(events_mutex, portMAX_DELAY);
+    uint32_t first = (event_count > ALERT_EVENTS) ? event_count - ALERT_EVENTS : 0;
+    first = max(first, since);
+    for (uint32_t id = first + 1; id <= event_count; id++) {
+        const AlertEvent &event = events[(id - 1) % ALERT_EVENTS];
+        const AssetData &data = assets[rules[event.rule].asset];
+        char text[PRICE_TEXT_SIZE];
+        formatPrice(text, sizeof(text), event.price, data.digits, '\0');
+        out.printf("%s{\"id\":%u,\"time\":%ld,\"rule\":", (id > first + 1) ? "," : "", event.id, (long)event.time);
+        printJsonString(out, rules[event.rule].text);
+        out.print(",\"asset\":");
+        printJsonString(out, data.asset_name);
+        out.printf(",\"price\":\"%s\",\"change\":%.2f}", text, event.change);
+    }
+    xSemaphoreGive(events_mutex);
+
+    out.print("]}");
+}
+
+/**
+ * Parses the alert rules and registers the /alerts route of the web interface
+ */
+void initAlerts() {
+    events_mutex = xSemaphoreCreateMutex();
+    num_rules = 0;
+    if (dc.alerts_enabled) {
+        parseAlertList();
+        LOG_SINFO("%d alert rules", num_rules);
+    }
+    buildLevels();
+
+    wp.on("/alerts", [](AsyncWebServerRequest *request) {
+        uint32_t since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), nullptr, 10) : 0;
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        writeAlertsJson(*response, since);
+        request->send(response);
+    });
+}
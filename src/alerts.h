@@ -0,0 +1,56 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <Arduino.h>
+#include "price.h"
+
+#define ALERT_MAX            16      // rules of alert_list
+#define ALERT_LEVELS         (2 * ALERT_MAX)   // a move rule has a rising and a falling level
+#define ALERT_TEXT_LENGTH    24
+#define ALERT_EVENTS         16      // fired alerts kept for the web interface
+#define ALERT_BLINK          500     // ms per flash phase
+#define ALERT_DEADBAND       20      // basis points of a price level, the price has to move back before it fires again
+#define ALERT_MOVE_DEADBAND  0.5f    // percentage points, the same for move levels
+
+enum AlertType : uint8_t {
+    ALERT_ABOVE = 0,        // price rises to or above the threshold
+    ALERT_BELOW,            // price falls to or below the threshold
+    ALERT_MOVE              // change of the history window reaches +/- threshold percent
+};
+
+struct AlertRule {
+    uint8_t asset;
+    AlertType type;
+    Price price;                    // ALERT_ABOVE, ALERT_BELOW
+    float percent;                  // ALERT_MOVE
+    char text[ALERT_TEXT_LENGTH];   // rule as configured, e.g. "BTC>110000"
+};
+
+// Threshold of one rule, kept sorted per asset
+template <typename T>
+struct AlertLevel {
+    T value;
+    T rearm;                // after firing, the value has to cross back over it before the level fires again
+    uint8_t rule;
+    bool rising;            // fires when the value crosses upwards, else downwards
+    bool armed;
+};
+
+// Fired levels of one asset waiting to re-arm
+struct DisarmedCount {
+    uint8_t rising;
+    uint8_t falling;
+};
+
+struct AlertEvent {
+    uint32_t id;            // increasing, /alerts?since=<id> returns newer events only
+    time_t time;
+    uint8_t rule;
+    Price price;
+    float change;
+};
+
+void initAlerts();
+int checkAlerts();
+
+#endif // ALERTS_H
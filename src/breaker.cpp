@@ -0,0 +1,61 @@
+#include "globals.h"
+#include "breaker.h"
+
+/**
+ * @return true if a request may be sent, false if it has to fail fast
+ */
+bool CircuitBreaker::allow(ulong now) {
+    switch (state) {
+        case CLOSED:
+            return true;
+        case OPEN:
+            if ((long)(now - retry_at) >= 0) {
+                // let one probe through
+                state = HALF_OPEN;
+                return true;
+            }
+            return false;
+        case HALF_OPEN:
+            // probe still pending
+            return false;
+    }
+    return true;
+}
+
+void CircuitBreaker::success() {
+    if (state != CLOSED) {
+        LOG_SINFO("Circuit breaker closed");
+    }
+    reset();
+}
+
+void CircuitBreaker::failure(ulong now, const char *name) {
+    if (state == CLOSED && ++failures < BREAKER_THRESHOLD) {
+        return;
+    }
+
+    // open, or reopen after a failed probe with twice the backoff
+    backoff = (state == HALF_OPEN) ? backoff * 2 : BACKOFF_BASE;
+    if (backoff > BACKOFF_MAX) {
+        backoff = BACKOFF_MAX;
+    }
+    // equal jitter: half fixed, half random, spreads the probes of several devices
+    ulong delay_ms = backoff / 2 + random(backoff / 2 + 1);
+    retry_at = now + delay_ms;
+    state = OPEN;
+    LOG_SINFO("Circuit breaker open for %s, retry in %lu s", name, delay_ms / 1000);
+}
+
+// the allowed request had no result that can be attributed (e.g. host down), probe again later
+void CircuitBreaker::release() {
+    if (state == HALF_OPEN) {
+        state = OPEN;
+    }
+}
+
+void CircuitBreaker::reset() {
+    state = CLOSED;
+    failures = 0;
+    backoff = 0;
+    retry_at = 0;
+}
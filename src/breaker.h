@@ -0,0 +1,40 @@
+#ifndef BREAKER_H
+#define BREAKER_H
+
+#include <Arduino.h>
+
+#define BREAKER_THRESHOLD   3         // consecutive failures that open the breaker
+#define BACKOFF_BASE        5000      // first open period in ms
+#define BACKOFF_MAX         600000    // max. open period in ms
+
+/**
+ * Circuit breaker with jittered exponential backoff
+ * CLOSED:    requests pass, failures are counted
+ * OPEN:      requests fail fast until the (jittered) backoff has expired
+ * HALF_OPEN: a single probe request passes, success closes the breaker, failure reopens it
+ *            with twice the backoff
+ */
+class CircuitBreaker {
+  public:
+    enum State : uint8_t {
+        CLOSED = 0,
+        OPEN,
+        HALF_OPEN
+    };
+
+    bool allow(ulong now);
+    void success();
+    void failure(ulong now, const char *name);
+    void release();
+    void reset();
+    State getState() const { return state; }
+    ulong getRetryTime() const { return retry_at; }
+
+  private:
+    State state = CLOSED;
+    uint8_t failures = 0;
+    ulong backoff = 0;
+    ulong retry_at = 0;
+};
+
+#endif // BREAKER_H
@@ -17,4 +17,15 @@
 // NTP interval in minutes
 #define NTP_UPDATE_INTERVAL 720
 
+// Mark price WebSocket stream, override with build flags to use a local stand-in server
+#ifndef PRICE_STREAM_HOST
+#define PRICE_STREAM_HOST "fstream.binance.com"
+#endif
+#ifndef PRICE_STREAM_PORT
+#define PRICE_STREAM_PORT 443
+#endif
+#ifndef PRICE_STREAM_TLS
+#define PRICE_STREAM_TLS 1
+#endif
+
 #endif // HARDWARE_H
@@ -16,18 +16,7 @@ struct DeviceConfig {
     uint16_t check_sum;
 
     // ===== Display =============
-    char symbol1[17];
-    char symbol2[17];
-    char symbol3[17];
-    char symbol4[17];
-    char asset1[7];
-    char asset2[7];
-    char asset3[7];
-    char asset4[7];
-    uint16_t digits1;
-    uint16_t digits2;
-    uint16_t digits3;
-    uint16_t digits4;
+    char asset_list[321];          // "SYMBOL:NAME:DIGITS,...", up to MAX_ASSETS
 
     uint16_t history_window;
     uint16_t price_update;
@@ -37,6 +26,26 @@ struct DeviceConfig {
     bool show_hw;
     bool show_hp;
     bool show_time;
+    bool show_windows;
+    char change_windows[25];
+    bool show_stats;
+    bool thousands_sep;
+    uint16_t ema_period;
+    bool show_mark;
+    bool show_funding;
+    bool framebuffer;
+    uint16_t shift_interval;        // s, 0 = shift with each asset
+    uint16_t transition;            // Transition, needs the framebuffer
+    uint16_t transition_ms;
+    bool alerts_enabled;
+    char alert_list[161];           // "NAME>PRICE,NAME<PRICE,NAME%PERCENT", up to ALERT_MAX
+    uint16_t alert_flash;
+    bool batch_fetch;
+    bool stream_enabled;
+    bool adaptive_poll;
+    bool backfill;
+    uint16_t poll_min;
+    uint16_t poll_budget;
 
     // ===== Framework: WiFi =====
     char wifi_ssid[33];
@@ -77,30 +86,37 @@ struct DeviceConfig {
 // default prefs
 const std::vector<WebPrefs::input_field> input_fields = {
 // ===== Display =============
-    FIELD_STRING(   symbol1,          "BTCUSDT",            3,        nullptr),
-    FIELD_STRING(   symbol2,          "ETHUSDT",            3,        nullptr),
-    FIELD_STRING(   symbol3,          "XAUUSDT",            3,        nullptr),
-    FIELD_STRING(   symbol4,          "XAGUSDT",            3,        nullptr), 
-
-    FIELD_STRING(   asset1,          "BTC",                 1,        nullptr),
-    FIELD_STRING(   asset2,          "ETH",                 1,        nullptr),
-    FIELD_STRING(   asset3,          "XAU",                 1,        nullptr),
-    FIELD_STRING(   asset4,          "XAG",                 1,        nullptr),
-
-    FIELD_UINT16(   digits1,          "2",                  1, 7,     nullptr),
-    FIELD_UINT16(   digits2,          "2",                  1, 7,     nullptr),
-    FIELD_UINT16(   digits3,          "2",                  1, 7,     nullptr),
-    FIELD_UINT16(   digits4,          "2",                  1, 7,     nullptr),
+    FIELD_STRING(   asset_list,       "BTCUSDT:BTC:2,ETHUSDT:ETH:2,XAUUSDT:XAU:2,XAGUSDT:XAG:2", 3, nullptr),
 
 
     FIELD_UINT16(   price_update,     "1",                  1, 60,    nullptr),
     FIELD_UINT16(   display_time,     "5",                  1, 60,    nullptr),
-    FIELD_UINT16(   history_window,   "12",                 1, 24,    nullptr),
+    FIELD_UINT16(   history_window,   "12",                 1, 168,    nullptr),
     FIELD_CHECKBOX( show_percent,     "on",                           nullptr),
     FIELD_CHECKBOX( show_hw,          "on",                           nullptr),
     FIELD_CHECKBOX( show_hp,          "on",                           nullptr),
     FIELD_CHECKBOX( show_time,        "on",                           nullptr),  
+    FIELD_CHECKBOX( show_windows,     "on",                           nullptr),
+    FIELD_STRING(   change_windows,   "1h,4h,24h,7d",       0,        nullptr),
+    FIELD_CHECKBOX( show_stats,       "off",                          nullptr),
+    FIELD_CHECKBOX( thousands_sep,    "off",                          nullptr),
+    FIELD_UINT16(   ema_period,       "20",                 2, 1000,  nullptr),
+    FIELD_CHECKBOX( show_mark,        "off",                          nullptr),
+    FIELD_CHECKBOX( show_funding,     "off",                          nullptr),
+    FIELD_CHECKBOX( framebuffer,      "off",                          nullptr),
+    FIELD_UINT16(   shift_interval,   "0",                  0, 3600,  nullptr),
+    FIELD_UINT16(   transition,       "0",                  0, 2,     nullptr),
+    FIELD_UINT16(   transition_ms,    "400",                100, 3000, nullptr),
+    FIELD_CHECKBOX( alerts_enabled,   "off",                          nullptr),
+    FIELD_STRING(   alert_list,       "BTC>120000,BTC<80000,ETH%5", 0,  nullptr),
+    FIELD_UINT16(   alert_flash,      "10",                 1, 300,   nullptr),
     FIELD_UINT16(   x_offset,         "5",                  0, 10,    nullptr),
+    FIELD_CHECKBOX( batch_fetch,      "on",                           nullptr),
+    FIELD_CHECKBOX( stream_enabled,   "off",                          nullptr),
+    FIELD_CHECKBOX( adaptive_poll,    "on",                           nullptr),
+    FIELD_UINT16(   poll_min,         "15",                 5, 600,   nullptr),
+    FIELD_UINT16(   poll_budget,      "30",                 1, 1200,  nullptr),
+    FIELD_CHECKBOX( backfill,         "on",                           nullptr),
 
 // ===== Framework: WiFi =====
     FIELD_STRING(   wifi_ssid,        WIFI_SSID,            1,        nullptr),
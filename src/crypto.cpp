@@ -1,129 +1,1047 @@
 #include "globals.h"
 #include "display.h"
 #include "network.h"
+#include "crypto.h"
+#include "pricestream.h"
+#include "metrics.h"
+#include "scheduler.h"
+#include "breaker.h"
+#include "spsc.h"
+#include "dnscache.h"
+#include "historylog.h"
+#include "synthetic.h"
 
-float getBinancePrice(const char* symbol) {
+#define BINANCE_PREMIUM_INDEX_URL "https://fapi.binance.com/fapi/v1/premiumIndex"
+#define BINANCE_INDEX_KLINES_URL  "https://fapi.binance.com/fapi/v1/indexPriceKlines"
+#define BACKFILL_REQUEST_TIMEOUT  10000
+// request weights of the exchange
+#define WEIGHT_PREMIUM_INDEX      1
+#define WEIGHT_PREMIUM_INDEX_ALL  10
+
+// fetch task -> render task
+static SpscQueue<PriceSnapshot, SNAPSHOT_QUEUE_SIZE> snapshots;
+static SpscQueue<MarketSnapshot, MARKET_QUEUE_SIZE> market_updates;
+
+// Change windows (render task only)
+ChangeWindow change_windows[CHANGE_WINDOWS_MAX];
+int num_change_windows = 0;
+
+// rollup levels, finest first
+static const uint16_t rollup_periods[ROLLUP_LEVELS] = { 5, 60 };
+static const uint16_t rollup_max_slots[ROLLUP_LEVELS] = { 24 * 12 + 1, 31 * 24 + 1 };
+static RollupRing rollups[MAX_ASSETS][ROLLUP_LEVELS];
+static uint16_t rollup_slots[ROLLUP_LEVELS];         // slots per ring of each level, 0 = level unused
+static int8_t window_level[CHANGE_WINDOWS_MAX];     // rollup level per window, -1 = raw history
+static uint32_t sample_minute = 0;                  // minute of the newest history sample since the first one
+static bool history_started = false;
+static Price newest_sample[MAX_ASSETS];
+static bool windows_dirty = false;
+static uint32_t history_samples = 0;                // raw history and longest change window
+
+// latest valid price per asset, held for the history samples (fetch task only)
+static Price latest_prices[MAX_ASSETS];
+// fails fast for symbols that keep failing (e.g. delisted or misspelled) (fetch task only)
+static CircuitBreaker symbol_breakers[MAX_ASSETS];
+
+// Asset arena: one allocation for the stores of all assets, struct-of-arrays
+// [history blocks asset 0 .. n-1][statistics asset 0 .. n-1][rollup slots level 0: asset 0 .. n-1]...
+// [statistics deques asset 0 .. n-1]
+static PriceHistory histories[MAX_ASSETS];
+static uint64_t *arena = nullptr;
+
+/**
+ * Feeds the timing and rate limit headers of the last request to metrics and request governor
+ */
+static void afterRequest(const char* key) {
+    const HttpTiming &timing = getLastHttpTiming();
+    const HttpRateInfo &rate = getLastRateInfo();
+    recordFetch(key, timing);
+    if (timing.code != HTTP_BREAKER_OPEN) {
+        updateRateLimit(timing.code, rate.used_weight, rate.retry_after, TIMENOW);
+    }
+}
+
+/**
+ * Validates and converts a price value parsed from a premiumIndex object or a kline
+ * The exchange sends prices as decimal strings, they are converted to fixed-point without a float.
+ *
+ * @param value  JSON value of the price field
+ * @param field  Field name used for logging
+ * @param symbol Symbol name used for logging
+ * @return the price or 0 if the field is missing or invalid
+ */
+static Price parsePrice(JsonVariantConst value, const char* field, const char* symbol) {
+    // Validate that the price field exists and is valid
+    if (value.isNull()) {
+        LOG_SERROR("%s field missing for %s", field, symbol);
+        return 0;
+    }
+
+    Price price = 0;
+    if (value.is<const char*>()) {
+        if (!parseDecimalPrice(value.as<const char*>(), price)) {
+            LOG_SERROR("Invalid price for %s: %s", symbol, value.as<const char*>());
+            price = 0;
+        }
+    } else {
+        // plain JSON number
+        double number = value.as<double>();
+        if (isnan(number) || isinf(number) || number < 0.0 || number >= 1e10) {
+            LOG_SERROR("Invalid price for %s: %f", symbol, number);
+            return 0;
+        }
+        price = priceFromFloat(number);
+    }
+    return price;
+}
+
+/**
+ * Fetches the index price of one asset, mark price and funding are taken from the same response
+ *
+ * @param symbol Symbol (pair) name
+ * @param info   Output market info, mark_price 0 if not available
+ * @return index price, 0 on errors
+ */
+Price getBinancePrice(const char* symbol, MarketInfo &info) {
+    info = {};
     if (WiFi.status() != WL_CONNECTED) {
         LOG_SDEBUG("WiFi not connected");
-        return 0.0f;
+        return 0;
     }
 
     char url[128];
-    snprintf(url, sizeof(url), "https://fapi.binance.com/fapi/v1/premiumIndex?symbol=%s", symbol);
+    snprintf(url, sizeof(url), BINANCE_PREMIUM_INDEX_URL "?symbol=%s", symbol);
+
+    Price price = 0;
+    int code;
 
-    float price = 0.0f;
-    if(httpGet(url, result)) {
+    bool success = httpGetStream(url, [&](Stream &stream) -> bool {
+        JsonDocument filter;
+        filter["indexPrice"] = true;
+        filter["markPrice"] = true;
+        filter["lastFundingRate"] = true;
+        filter["nextFundingTime"] = true;
 
         JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, result.payload);
+        DeserializationError error = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
 
         if (error) {
             LOG_SERROR("JSON parse failed for %s: %s", symbol, error.c_str());
-            return 0.0f;
+            return false;
         }
 
-        // Validate that indexPrice field exists and is valid
-        if (!doc["indexPrice"].isNull()) {
-            price = doc["indexPrice"].as<float>();
+        price = parsePrice(doc["indexPrice"], "indexPrice", symbol);
+        parseMarketInfo(doc["markPrice"].as<const char*>(), doc["lastFundingRate"].as<const char*>(),
+                        doc["nextFundingTime"].as<uint64_t>(), info);
+        return true;
+    }, code);
+    afterRequest(symbol);
+
+    // parse errors are logged by the handler
+    if (!success && (code <= 0 || code >= 400)) {
+        LOG_SERROR("HTTP error for %s: %d", symbol, code);
+    }
+
+    return price;
+}
+
+/**
+ * Fetches the prices of all assets with a single premiumIndex request
+ * The full market array is parsed object by object straight from the socket,
+ * only symbol, index price, mark price and funding of each object are kept.
+ *
+ * @param prices Output array of num_assets prices, 0 for symbols not found
+ * @param infos  Output array of num_assets market infos, mark_price 0 for symbols not found
+ * @return number of assets with a valid price
+ */
+int getBinancePrices(Price* prices, MarketInfo* infos) {
+    for (int i = 0; i < num_assets; i++) {
+        prices[i] = 0;
+        infos[i] = {};
+    }
+
+    if (WiFi.status() != WL_CONNECTED) {
+        LOG_SDEBUG("WiFi not connected");
+        return 0;
+    }
 
-            // Validate the price is a real number
-            if (isnan(price) || isinf(price) || price < 0.0f) {
-                LOG_SERROR("Invalid price for %s: %f", symbol, price);
-                price = 0.0f;
+    int found = 0;
+    int code;
+
+    bool success = httpGetStream(BINANCE_PREMIUM_INDEX_URL, [&](Stream &stream) -> bool {
+        JsonDocument filter;
+        filter["symbol"] = true;
+        filter["indexPrice"] = true;
+        filter["markPrice"] = true;
+        filter["lastFundingRate"] = true;
+        filter["nextFundingTime"] = true;
+
+        if (!stream.find("[")) {
+            LOG_SERROR("premiumIndex response is not an array");
+            return false;
+        }
+
+        do {
+            JsonDocument doc;
+            DeserializationError error = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
+            if (error) {
+                LOG_SERROR("JSON parse failed for premiumIndex: %s", error.c_str());
+                return false;
             }
-        } else {
-            LOG_SERROR("indexPrice field missing for %s", symbol);
+
+            const char* symbol = doc["symbol"];
+            if (symbol == nullptr) {
+                continue;
+            }
+
+            for (int i = 0; i < num_fetched; i++) {
+                if (prices[i] == 0 && strcasecmp(symbol, assets[i].symbol) == 0) {
+                    prices[i] = parsePrice(doc["indexPrice"], "indexPrice", symbol);
+                    parseMarketInfo(doc["markPrice"].as<const char*>(), doc["lastFundingRate"].as<const char*>(),
+                                    doc["nextFundingTime"].as<uint64_t>(), infos[i]);
+                    if (prices[i] > 0) {
+                        found++;
+                    }
+                }
+            }
+            // stop reading as soon as every configured symbol was seen
+            if (found == num_fetched) {
+                break;
+            }
+        } while (stream.findUntil(",", "]"));
+
+        return true;
+    }, code);
+    afterRequest("premiumIndex");
+
+    if (!success && (code <= 0 || code >= 400)) {
+        LOG_SERROR("HTTP error for premiumIndex: %d", code);
+    } else if (found < num_fetched) {
+        LOG_SDEBUG("premiumIndex: %d of %d symbols found", found, num_fetched);
+    }
+    return found;
+}
+
+/**
+ * Publishes a snapshot to the render task (fetch task only)
+ */
+static void publishSnapshot(const PriceSnapshot &snapshot) {
+    if (!snapshots.push(snapshot)) {
+        LOG_SERROR("Snapshot queue full, prices dropped");
+    }
+}
+
+/**
+ * Publishes mark price and funding to the render task (fetch task only)
+ * Display only data, dropped if the render task is busy with a backfill.
+ */
+static void publishMarket(const MarketSnapshot &market) {
+    for (int i = 0; i < num_fetched; i++) {
+        if (market.info[i].mark_price > 0) {
+            if (!market_updates.push(market)) {
+                LOG_SDEBUG("Market queue full, update dropped");
+            }
+            return;
         }
-    } else {
-        LOG_SERROR("HTTP error for %s: %d", symbol, result.code);
     }
+}
 
-    return price;
+/**
+ * Keeps the valid prices of a snapshot as latest prices and publishes it (fetch task only)
+ * The synthetic assets are recomputed from the latest prices of their legs.
+ */
+static void publishPrices(PriceSnapshot &snapshot) {
+    for (int i = 0; i < num_fetched; i++) {
+        if (snapshot.prices[i] > 0) {
+            latest_prices[i] = snapshot.prices[i];
+        }
+    }
+    evaluateSynthetics(latest_prices);
+    for (int i = num_fetched; i < num_assets; i++) {
+        snapshot.prices[i] = latest_prices[i];
+    }
+    publishSnapshot(snapshot);
 }
 
+/**
+ * Fetches the prices of all due assets within the request budget (fetch task only)
+ * Each asset has its own deadline from the volatility scheduler, a batch request refreshes all.
+ */
 void updatePrices() {
-    LOG_SDEBUG("Fetching prices... Free heap: %d bytes", ESP.getFreeHeap());
+    ulong now = TIMENOW;
+    int due = getDueAsset(now);
+    if (due < 0 || WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+
+    PriceSnapshot snapshot;
+    snapshot.type = SNAPSHOT_PRICES;
+    MarketSnapshot market = {};
+
+    if (dc.batch_fetch) {
+        if (!takeRequestToken(now, WEIGHT_PREMIUM_INDEX_ALL)) {
+            return;
+        }
+        LOG_SDEBUG("Fetching prices... Free heap: %d bytes", ESP.getFreeHeap());
+        // One round trip for all assets
+        getBinancePrices(snapshot.prices, market.info);
+        for (int i = 0; i < num_fetched; i++) {
+            recordPoll(i, snapshot.prices[i], now);
+        }
+        scheduleAll(now);
+    } else {
+        for (int i = 0; i < num_assets; i++) {
+            snapshot.prices[i] = 0;
+        }
+        for (; due >= 0; due = getDueAsset(now)) {
+            CircuitBreaker &breaker = symbol_breakers[due];
+            if (!breaker.allow(now)) {
+                scheduleNext(due, now);
+                deferUntil(due, breaker.getRetryTime());
+                continue;
+            }
+            if (!takeRequestToken(now, WEIGHT_PREMIUM_INDEX)) {
+                LOG_SDEBUG("Request budget exhausted, %s deferred", assets[due].symbol);
+                break;
+            }
+
+            snapshot.prices[due] = getBinancePrice(assets[due].symbol, market.info[due]);
+            recordPoll(due, snapshot.prices[due], now);
+            scheduleNext(due, now);
+
+            int code = getLastHttpTiming().code;
+            if (snapshot.prices[due] > 0) {
+                breaker.success();
+            } else if (code > 0 && code < 500) {
+                // the host answered, but not with a valid price for this symbol
+                breaker.failure(now, assets[due].symbol);
+            } else {
+                // host problem, handled by the host breaker
+                breaker.release();
+            }
+            if (code == HTTP_BREAKER_OPEN) {
+                // no request was sent
+                continue;
+            }
+            LOG_SDEBUG("%s fetched, next in %lu s", assets[due].symbol, getPollInterval(due) / 1000);
+
+            if (getDueAsset(now) >= 0) {
+                delay(100); // Small delay between requests
+            }
+        }
+    }
+
+    publishPrices(snapshot);
+    publishMarket(market);
+
+    const HttpPoolStats &stats = getHttpPoolStats();
+    LOG_SDEBUG("Prices fetched! Free heap: %d bytes, HTTP requests: %u reused: %u connects: %u idle closed: %u",
+               ESP.getFreeHeap(), stats.requests, stats.reused, stats.connects, stats.idle_closed);
+}
+
+/**
+ * Publishes the latest prices as history sample and appends it to the history log (fetch task only)
+ * Samples are taken on the fixed price_update grid, independent of the poll intervals. The log is
+ * written here, so the render task never waits for a flash write.
+ */
+static void samplePrices() {
+    PriceSnapshot snapshot;
+    snapshot.type = SNAPSHOT_SAMPLE;
+    memcpy(snapshot.prices, latest_prices, sizeof(latest_prices));
+    publishSnapshot(snapshot);
+    appendHistoryLog(latest_prices, time(nullptr));
+}
 
-    // Fetch all prices and store in buffers
-    for (int i = 0; i < NUM_ASSETS; i++) {
-        yield(); // Feed watchdog before each request
+/**
+ * Updates the reference prices of all change windows after a history sample, the changes
+ * against the current price are calculated on every price update
+ */
+static void updateWindowPrices(int asset_index) {
+    AssetData &asset = assets[asset_index];
+    const PriceHistory &history = *asset.history;
 
-        float new_price = getBinancePrice(assets[i].symbol);
+    for (int w = 0; w < num_change_windows; w++) {
+        uint32_t minutes = change_windows[w].minutes;
+        if (window_level[w] < 0) {
+            uint32_t back = minutes / dc.price_update;
+            uint32_t size = history.size();
+            if (back >= history.span()) {
+                // the history store ran out, no change rather than the change of a shorter window
+                asset.window_price[w] = 0;
+            } else {
+                asset.window_price[w] = history.get((size > back + 1) ? size - 1 - back : 0);
+            }
+        } else {
+            uint32_t minute = (sample_minute > minutes) ? sample_minute - minutes : 0;
+            asset.window_price[w] = rollups[asset_index][window_level[w]].at(minute);
+        }
+    }
+}
+
+/**
+ * Adds one history sample of all assets to the history, the statistics and the rollup rings
+ * (live, replayed or backfilled)
+ *
+ * @param prices Price per asset
+ * @param step   Minutes since the previous sample
+ * @param raw    false = rollup rings only (backfill older than the raw history)
+ */
+static void storeSample(const Price *prices, uint16_t step, bool raw) {
+    if (history_started) {
+        sample_minute += step;
+    }
+    history_started = true;
+
+    for (int i = 0; i < num_assets; i++) {
+        if (raw) {
+            assets[i].history->push(prices[i]);
+            if (assets[i].stats != nullptr) {
+                assets[i].stats->update(*assets[i].history);
+            }
+        }
+        for (int level = 0; level < ROLLUP_LEVELS; level++) {
+            rollups[i][level].update(prices[i], sample_minute);
+        }
+    }
+    memcpy(newest_sample, prices, sizeof(newest_sample));
+}
+
+/**
+ * Stores a snapshot into the assets and the history buffers (render task only)
+ */
+static void storePrices(const PriceSnapshot &snapshot) {
+    Price prices[MAX_ASSETS];
+
+    switch (snapshot.type) {
+        case SNAPSHOT_BACKFILL:
+        case SNAPSHOT_BACKFILL_ROLLUP:
+            storeSample(snapshot.prices, snapshot.count, snapshot.type == SNAPSHOT_BACKFILL);
+            windows_dirty = true;
+            return;
+
+        case SNAPSHOT_FILL:
+            if (history_started) {
+                storeSample(newest_sample, dc.price_update, true);
+            }
+            windows_dirty = true;
+            return;
+
+        default:
+            break;
+    }
+
+    bool sample = (snapshot.type == SNAPSHOT_SAMPLE);
+    for (int i = 0; i < num_assets; i++) {
+        Price new_price = snapshot.prices[i];
 
         // Only update if we got a valid price (not 0 from error)
-        if (new_price > 0.0f) {
+        if (new_price > 0) {
             assets[i].current_price = new_price;
-            assets[i].price_buffer[buffer_index] = new_price;
-        } else {
+        } else if (sample) {
             LOG_SDEBUG("Skipping invalid price for %s, keeping previous", assets[i].symbol);
-            // Keep the previous price in the buffer
-            assets[i].price_buffer[buffer_index] = assets[i].current_price;
         }
 
-        if (i < NUM_ASSETS - 1) {
-            delay(100); // Small delay between requests (also feeds watchdog)
+        // Keeps the previous price in the history on error
+        prices[i] = assets[i].current_price;
+    }
+
+    if (!sample) {
+        return;
+    }
+
+    storeSample(prices, dc.price_update, true);
+    windows_dirty = true;
+
+    static bool window_full = false;
+    if (!window_full) {
+        int full = 0;
+        for (int i = 0; i < num_assets; i++) {
+            full += assets[i].history->full() ? 1 : 0;
+        }
+        if (full == num_assets) {
+            window_full = true;
+            LOG_SINFO("Buffer full - Rolling window active!");
         }
     }
+}
 
-    LOG_SDEBUG("Prices updated! Free heap: %d bytes", ESP.getFreeHeap());
+/**
+ * Applies all snapshots published by the fetch task since the last call (render task only)
+ *
+ * @return number of applied snapshots
+ */
+int applyPriceSnapshots() {
+    PriceSnapshot snapshot;
+    int count = 0;
+    // bounded, a replay or backfill keeps the queue filled and is spread over several passes
+    while (count < SNAPSHOT_QUEUE_SIZE && snapshots.pop(snapshot)) {
+        storePrices(snapshot);
+        count++;
+    }
 
-    // Increment circular buffer index
-    buffer_index = (buffer_index + 1) % buffer_size;
+    MarketSnapshot market;
+    while (market_updates.pop(market)) {
+        for (int i = 0; i < num_fetched; i++) {
+            if (market.info[i].mark_price > 0) {
+                assets[i].market = market.info[i];
+            }
+        }
+    }
+
+    // once per pass, a backfill delivers many samples at once
+    if (windows_dirty) {
+        windows_dirty = false;
+        for (int i = 0; i < num_assets; i++) {
+            updateWindowPrices(i);
+        }
+    }
+    return count;
+}
 
-    // Buffer is full when index reaches 0 again
-    if (buffer_index == 0 && !buffer_full) {
-        buffer_full = true;
-        LOG_SINFO("Buffer full - Rolling window active!");
+// ====================================================================================================
+// Backfill ===========================================================================================
+// ====================================================================================================
+/**
+ * Publishes a snapshot, waits while the render task catches up (fetch task only)
+ */
+static void publishBlocking(const PriceSnapshot &snapshot) {
+    while (!snapshots.push(snapshot)) {
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
 
-float getOldPrice(int asset_index) {
-    if (asset_index < 0 || asset_index >= NUM_ASSETS) {
-        return 0.0f;
+/**
+ * Publishes a sample of the history log (fetch task only)
+ * The replay holds log_mutex while it waits for the queue, the render task draining it never takes log_mutex.
+ */
+static void publishLoggedSample(const Price *prices) {
+    PriceSnapshot snapshot;
+    snapshot.type = SNAPSHOT_BACKFILL;
+    snapshot.count = dc.price_update;
+    memcpy(snapshot.prices, prices, num_assets * sizeof(Price));
+    publishBlocking(snapshot);
+}
+
+/**
+ * Replays the history log into the render task through the snapshot queue (fetch task only)
+ *
+ * @param fill_to_now Fill the gap from the last record up to now (false if it is backfilled)
+ */
+static void replayHistory(bool fill_to_now) {
+    ulong start = TIMENOW;
+    uint32_t count = replayHistoryLog(publishLoggedSample, fill_to_now);
+    if (count > 0) {
+        LOG_SINFO("History restored: %u samples in %lu ms", count, TIMENOW - start);
     }
+}
 
-    int oldest_index = buffer_full ? buffer_index : 0;
-    return assets[asset_index].price_buffer[oldest_index];
+/**
+ * Coarsest kline interval (minutes) that divides the sample step
+ */
+static uint8_t klineInterval(uint16_t step) {
+    static const uint8_t intervals[] = { 60, 30, 15, 5, 3, 1 };
+    for (uint8_t interval : intervals) {
+        if (step % interval == 0) {
+            return interval;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Request weight of a kline request
+ */
+static uint16_t klineWeight(uint16_t limit) {
+    return (limit < 100) ? 1 : (limit < 500) ? 2 : (limit <= 1000) ? 5 : 10;
+}
+
+/**
+ * Fetches index price klines and keeps the open price at every sample time
+ * The kline array is parsed element by element straight from the socket.
+ *
+ * @param symbol Symbol (pair) name
+ * @param start  Unix time of the first sample, aligned to the kline interval
+ * @param count  Number of samples
+ * @param step   Minutes between samples
+ * @param prices Output array of count prices, untouched for missing klines
+ * @return false on HTTP or parse errors
+ */
+static bool getBinanceKlines(const char *symbol, uint32_t start, uint16_t count, uint16_t step, Price *prices) {
+    uint8_t interval = klineInterval(step);
+    uint16_t limit = (uint32_t)count * step / interval;
+    char interval_name[4];
+    snprintf(interval_name, sizeof(interval_name), (interval == 60) ? "1h" : "%um", interval);
+
+    ulong wait_start = TIMENOW;
+    while (!takeRequestToken(TIMENOW, klineWeight(limit))) {
+        if (TIMENOW - wait_start > BACKFILL_TIMEOUT) {
+            LOG_SERROR("Backfill of %s: request budget exhausted", symbol);
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+
+    char url[192];
+    snprintf(url, sizeof(url), BINANCE_INDEX_KLINES_URL "?pair=%s&interval=%s&startTime=%u000&limit=%u",
+             symbol, interval_name, start, limit);
+
+    int code;
+    bool success = httpGetStream(url, [&](Stream &stream) -> bool {
+        if (!stream.find("[")) {
+            LOG_SERROR("klines response is not an array");
+            return false;
+        }
+        if (stream.peek() == ']') {
+            return true;
+        }
+
+        // [openTime, "open", "high", "low", "close", ...]
+        JsonDocument doc;
+        do {
+            DeserializationError error = deserializeJson(doc, stream);
+            if (error) {
+                LOG_SERROR("JSON parse failed for %s klines: %s", symbol, error.c_str());
+                return false;
+            }
+
+            uint32_t offset = (uint32_t)(doc[0].as<uint64_t>() / 1000) - start;
+            if (offset % (step * 60U) != 0) {
+                continue;
+            }
+            uint32_t index = offset / (step * 60U);
+            if (index >= count) {
+                break;
+            }
+            prices[index] = parsePrice(doc[1], "kline open", symbol);
+        } while (stream.findUntil(",", "]"));
+        return true;
+    }, code, BACKFILL_REQUEST_TIMEOUT);
+    afterRequest(symbol);
+
+    if (!success && (code <= 0 || code >= 400)) {
+        LOG_SERROR("HTTP error for %s klines: %d", symbol, code);
+    }
+    return success;
+}
+
+/**
+ * Backfills samples of all assets, oldest first, in chunks of one kline request per asset
+ *
+ * @param start    Unix time of the first sample
+ * @param count    Number of samples
+ * @param step     Minutes between samples
+ * @param type     SNAPSHOT_BACKFILL or SNAPSHOT_BACKFILL_ROLLUP
+ * @param previous Unix time of the previous history sample (0 = none), updated
+ * @param log      Append the samples to the history log (newer than its last record only)
+ * @return published samples
+ */
+static uint32_t backfillRange(uint32_t start, uint32_t count, uint16_t step, SnapshotType type, uint32_t &previous,
+                              bool log) {
+    uint16_t chunk = min((uint32_t)BACKFILL_CHUNK, (uint32_t)BACKFILL_KLINES_MAX * klineInterval(step) / step);
+    chunk = max(1, min((int)chunk, BACKFILL_BUFFER / num_fetched));
+    Price *prices = new (std::nothrow) Price[num_fetched * chunk];
+    if (prices == nullptr) {
+        return 0;
+    }
+
+    PriceSnapshot snapshot = {};
+    snapshot.type = type;
+    uint32_t done = 0;
+    while (done < count) {
+        uint16_t n = min((uint32_t)chunk, count - done);
+        uint32_t chunk_start = start + done * step * 60U;
+        memset(prices, 0, sizeof(Price) * num_fetched * chunk);
+
+        bool success = true;
+        for (int i = 0; i < num_fetched && success; i++) {
+            success = getBinanceKlines(assets[i].symbol, chunk_start, n, step, prices + i * chunk);
+        }
+        if (!success) {
+            break;
+        }
+
+        for (uint16_t k = 0; k < n; k++) {
+            for (int i = 0; i < num_fetched; i++) {
+                // missing klines repeat the previous price
+                if (prices[i * chunk + k] > 0) {
+                    snapshot.prices[i] = prices[i * chunk + k];
+                }
+            }
+            evaluateSynthetics(snapshot.prices);
+            uint32_t sample_time = chunk_start + k * step * 60U;
+            snapshot.count = (previous != 0) ? (sample_time - previous) / 60 : 0;
+            previous = sample_time;
+            publishBlocking(snapshot);
+            if (log) {
+                appendHistoryLog(snapshot.prices, sample_time);
+            }
+        }
+        done += n;
+    }
+
+    delete[] prices;
+    return done;
+}
+
+/**
+ * Builds the history at boot: backfills the part of the window before the history log from klines,
+ * replays the log and backfills the time the device was off (fetch task only)
+ * Samples older than the raw history only feed the rollup rings, they are backfilled at the
+ * rollup period instead of the price_update interval.
+ */
+static void startHistory() {
+    // the log replay and the backfill need the clock
+    ulong wait_start = TIMENOW;
+    while (TIMENOW - wait_start < HISTORY_RESTORE_WAIT &&
+           (WiFi.status() != WL_CONNECTED || (dc.ntp_enabled && time(nullptr) < HISTORY_CLOCK_VALID))) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    // current prices first
+    updatePrices();
+
+    uint32_t now = time(nullptr);
+    uint32_t log_first, log_last;
+    bool logged = getHistoryLogRange(log_first, log_last);
+    if (!dc.backfill || now < HISTORY_CLOCK_VALID || WiFi.status() != WL_CONNECTED || (logged && log_last == 0)) {
+        replayHistory(true);
+        return;
+    }
+
+    // sample times are aligned to the interval, so they match kline open times
+    const uint32_t interval = dc.price_update * 60U;
+    const uint16_t coarse_step = (dc.price_update <= rollup_periods[0]) ? rollup_periods[0] : rollup_periods[ROLLUP_LEVELS - 1];
+    uint32_t newest = now / interval * interval;
+    uint32_t raw_start = newest - (buffer_size - 1) * interval;
+    uint32_t window_start = newest - (history_samples - 1) * interval;
+
+    // a log ending before the raw history is useless, backfill everything
+    bool use_log = logged && log_last >= raw_start;
+    uint32_t end = use_log ? log_first : newest + interval;
+    uint32_t previous = 0;
+    uint32_t count = 0;
+    ulong start = TIMENOW;
+
+    // rollup part before the raw history
+    if (window_start < raw_start && end > window_start) {
+        uint32_t coarse = coarse_step * 60U;
+        uint32_t first = window_start / coarse * coarse;
+        uint32_t samples = (min(raw_start, end) - first + coarse - 1) / coarse;
+        count += backfillRange(first, samples, coarse_step, SNAPSHOT_BACKFILL_ROLLUP, previous, false);
+    }
+    // raw part before the log, logged if it is newer than the log (an append-only log cannot take older samples)
+    if (end > raw_start) {
+        uint32_t samples = (end - raw_start + interval - 1) / interval;
+        count += backfillRange(raw_start, samples, dc.price_update, SNAPSHOT_BACKFILL, previous, !use_log);
+    }
+
+    if (use_log) {
+        // the time the device was off
+        bool gap = newest >= log_last + interval;
+        replayHistory(!gap);
+
+        if (gap) {
+            uint32_t first = (log_last / interval + 1) * interval;
+            uint32_t samples = (newest - first) / interval + 1;
+            previous = log_last;
+            // logged, so the next boot replays these samples instead of bridging the gap with the last record
+            uint32_t done = backfillRange(first, samples, dc.price_update, SNAPSHOT_BACKFILL, previous, true);
+            count += done;
+            // one snapshot per missing sample, the render task applies them over several passes
+            PriceSnapshot fill = {};
+            fill.type = SNAPSHOT_FILL;
+            for (uint32_t n = done; n < samples; n++) {
+                publishBlocking(fill);
+            }
+        }
+    }
+    LOG_SINFO("History backfill: %u samples in %lu ms", count, TIMENOW - start);
+}
+
+/**
+ * Fetch task: streams ticks, polls due assets and takes the history samples
+ * All network I/O runs here, so the render task never blocks.
+ */
+static void fetchTask(void *param) {
+    initPriceStream();
+    initScheduler();
+    startHistory();
+
+    const ulong sample_interval = (ulong)dc.price_update * 60000UL;
+    ulong next_sample = TIMENOW;
+    uint32_t sample_count = 0;
+
+    for (;;) {
+        PriceSnapshot snapshot;
+        snapshot.type = SNAPSHOT_PRICES;
+        MarketSnapshot market;
+        if (handlePriceStream(snapshot.prices, market.info) > 0) {
+            publishPrices(snapshot);
+            publishMarket(market);
+        }
+
+        if (!isPriceStreamActive()) {
+            updatePrices();
+        }
+        handleDnsCache();
+        handleHttpConnections();
+
+        // fixed grid, a late sample does not shift the following ones
+        if ((long)(TIMENOW - next_sample) >= 0) {
+            next_sample += sample_interval;
+            samplePrices();
+
+            if (++sample_count % METRICS_LOG_INTERVAL == 0) {
+                printMetrics();
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(FETCH_TASK_INTERVAL));
+    }
+}
+
+Price getOldPrice(int asset_index) {
+    if (asset_index < 0 || asset_index >= num_assets) {
+        return 0;
+    }
+
+    return assets[asset_index].history->oldest();
 }
 
 void calculateChanges() {
-    int oldest_index = buffer_full ? buffer_index : 0;
+    for (int i = 0; i < num_assets; i++) {
+        // the window label follows the samples actually kept
+        uint32_t span = assets[i].history->span();
+        assets[i].window_minutes = (span > 0 && span < (uint32_t)buffer_size)
+            ? (span - 1) * dc.price_update : dc.history_window * 60;
 
-    for (int i = 0; i < NUM_ASSETS; i++) {
-        float old_price = assets[i].price_buffer[oldest_index];
-        if (old_price > 0.0f) {
-            assets[i].change_percent = ((assets[i].current_price - old_price) / old_price) * 100.0f;
+        // exact difference of the fixed-point prices, only the ratio is a float
+        Price current_price = assets[i].current_price;
+        Price old_price = assets[i].history->oldest();
+        if (old_price > 0) {
+            assets[i].change_percent = (double)(current_price - old_price) / old_price * 100.0;
         } else {
             assets[i].change_percent = 0.0f;
         }
+
+        for (int w = 0; w < num_change_windows; w++) {
+            Price window_price = assets[i].window_price[w];
+            assets[i].window_change[w] = (window_price > 0)
+                ? (double)(current_price - window_price) / window_price * 100.0
+                : 0.0f;
+        }
+    }
+}
+
+/**
+ * Parses the change window list, e.g. "30m,4h,24h,7d" (plain numbers are hours)
+ */
+static void parseChangeWindows() {
+    char list[sizeof(dc.change_windows)];
+    strlcpy(list, dc.change_windows, sizeof(list));
+
+    num_change_windows = 0;
+    char *save = nullptr;
+    for (char *token = strtok_r(list, ", ", &save); token != nullptr && num_change_windows < CHANGE_WINDOWS_MAX;
+         token = strtok_r(nullptr, ", ", &save)) {
+        char *unit;
+        long value = strtol(token, &unit, 10);
+        char suffix = (*unit == '\0') ? 'h' : tolower(*unit);
+        uint32_t factor = (suffix == 'm') ? 1 : (suffix == 'h') ? 60 : (suffix == 'd') ? 1440 : 0;
+        if (value <= 0 || factor == 0 || (uint32_t)value * factor > CHANGE_WINDOW_MAX_MINUTES) {
+            LOG_SERROR("Invalid change window: %s", token);
+            continue;
+        }
+
+        ChangeWindow &window = change_windows[num_change_windows++];
+        window.minutes = value * factor;
+        snprintf(window.label, sizeof(window.label), "%ld%c", value, suffix);
+    }
+}
+
+/**
+ * Serves each change window from the raw history if it covers the window, else from the finest
+ * rollup level that does, and sizes the rollup rings needed for that
+ */
+static void planRollups() {
+    parseChangeWindows();
+
+    uint32_t raw_minutes = (uint32_t)(buffer_size - 1) * dc.price_update;
+    for (int w = 0; w < num_change_windows; w++) {
+        uint32_t minutes = change_windows[w].minutes;
+        window_level[w] = -1;
+        if (minutes <= raw_minutes) {
+            continue;
+        }
+
+        // periods shorter than the sample interval would only repeat samples
+        for (int level = 0; level < ROLLUP_LEVELS; level++) {
+            if (rollup_periods[level] < dc.price_update && level < ROLLUP_LEVELS - 1) {
+                continue;
+            }
+            window_level[w] = level;
+            if ((uint32_t)rollup_periods[level] * (rollup_max_slots[level] - 1) >= minutes) {
+                break;
+            }
+        }
+
+        int level = window_level[w];
+        uint16_t needed = min((uint32_t)rollup_max_slots[level], minutes / rollup_periods[level] + 2);
+        rollup_slots[level] = max(rollup_slots[level], needed);
+    }
+
+    for (int level = 0; level < ROLLUP_LEVELS; level++) {
+        if (rollup_slots[level] > 0) {
+            LOG_SINFO("Rollup %d min: %d slots (%d bytes per asset)", rollup_periods[level], rollup_slots[level],
+                      rollup_slots[level] * sizeof(Price));
+        }
+    }
+}
+
+/**
+ * Parses the asset list, e.g. "BTCUSDT:BTC:2,ETHUSDT:ETH:2" (name defaults to the symbol, digits to 2)
+ * Synthetic assets are expressions over fetched symbols, e.g. "=XAUUSDT/XAGUSDT:AU/AG:2". They are
+ * parsed in a second pass and placed after the fetched assets.
+ */
+static void parseAssetList() {
+    num_assets = 0;
+    resetSynthetics();
+
+    for (int pass = 0; pass < 2; pass++) {
+        char list[sizeof(dc.asset_list)];
+        strlcpy(list, dc.asset_list, sizeof(list));
+
+        char *save = nullptr;
+        for (char *token = strtok_r(list, ", ", &save); token != nullptr; token = strtok_r(nullptr, ", ", &save)) {
+            bool synthetic = (token[0] == '=');
+            if (synthetic != (pass == 1)) {
+                continue;
+            }
+            if (num_assets >= MAX_ASSETS) {
+                LOG_SERROR("Too many assets (max. %d), %s ignored", MAX_ASSETS, token);
+                continue;
+            }
+
+            char *name = strchr(token, ':');
+            char *digits = nullptr;
+            if (name != nullptr) {
+                *name++ = '\0';
+                digits = strchr(name, ':');
+                if (digits != nullptr) {
+                    *digits++ = '\0';
+                }
+            }
+            size_t len = strlen(token);
+            if (synthetic ? !addSyntheticAsset(num_assets, token + 1, num_fetched)
+                          : (len < 3 || len >= ASSET_SYMBOL_LENGTH)) {
+                LOG_SERROR("Invalid %s: %s", synthetic ? "synthetic asset" : "symbol", token);
+                continue;
+            }
+
+            // a synthetic asset keeps its expression (truncated) as symbol
+            AssetData &asset = assets[num_assets++];
+            asset = {};
+            strlcpy(asset.symbol, token, sizeof(asset.symbol));
+            strlcpy(asset.asset_name, (name != nullptr && *name != '\0') ? name : token + (synthetic ? 1 : 0),
+                    sizeof(asset.asset_name));
+            asset.digits = (digits != nullptr && *digits != '\0') ? constrain(atoi(digits), 1, 7) : 2;
+        }
+
+        if (pass == 0 && num_assets == 0) {
+            LOG_SERROR("No valid asset configured, using BTCUSDT");
+            assets[0] = {};
+            strlcpy(assets[0].symbol, "BTCUSDT", sizeof(assets[0].symbol));
+            strlcpy(assets[0].asset_name, "BTC", sizeof(assets[0].asset_name));
+            assets[0].digits = 2;
+            num_assets = 1;
+        }
+        if (pass == 0) {
+            num_fetched = num_assets;
+        }
+    }
+}
+
+/**
+ * Allocates the asset arena and attaches the history, statistics and rollup stores of all assets
+ * The history blocks get what is left of the heap budget after the fixed-size stores.
+ */
+static void initArena() {
+    size_t rollup_bytes = 0;
+    for (int level = 0; level < ROLLUP_LEVELS; level++) {
+        rollup_bytes += rollup_slots[level] * sizeof(Price);
+    }
+    size_t deque_bytes = RollingStats::storageFor(buffer_size);
+    size_t fixed_bytes = num_assets * (sizeof(RollingStats) + rollup_bytes + deque_bytes);
+
+    // leave at least half of the heap to TLS and the web server, the arena is one block
+    size_t budget = min((size_t)ESP.getFreeHeap() / 2, (size_t)ESP.getMaxAllocHeap());
+    size_t max_blocks = (budget > fixed_bytes) ? (budget - fixed_bytes) / num_assets / sizeof(HistoryBlock) : 0;
+    uint16_t blocks = PriceHistory::blocksFor(buffer_size);
+    if (blocks > max_blocks) {
+        LOG_SERROR("Not enough heap for a %d h history, window will be shorter", dc.history_window);
+        blocks = max(max_blocks, (size_t)2);
+    }
+
+    size_t arena_size;
+    do {
+        arena_size = num_assets * blocks * sizeof(HistoryBlock) + fixed_bytes;
+        arena = new (std::nothrow) uint64_t[(arena_size + 7) / 8];
+    } while (arena == nullptr && (blocks /= 2) >= 2);
+    for (int i = 0; i < num_assets; i++) {
+        assets[i].history = &histories[i];
+    }
+    if (arena == nullptr) {
+        LOG_SERROR("Asset arena allocation failed, no history");
+        return;
+    }
+
+    LOG_SINFO("Asset arena: %d assets, %d bytes (%d history blocks per asset, %d bytes as float)",
+              num_assets, arena_size, blocks, buffer_size * sizeof(float) * num_assets);
+
+    uint8_t *next = (uint8_t *)arena;
+    HistoryBlock *block_pool = (HistoryBlock *)next;
+    next += num_assets * blocks * sizeof(HistoryBlock);
+    RollingStats *stats_pool = (RollingStats *)next;
+    next += num_assets * sizeof(RollingStats);
+    Price *slot_pool = (Price *)next;
+    next += num_assets * rollup_bytes;
+    // last, the 16-bit entries would misalign the 64-bit slots
+    uint16_t *deque_pool = (uint16_t *)next;
+
+    for (int i = 0; i < num_assets; i++) {
+        assets[i].window_minutes = dc.history_window * 60;
+        histories[i].begin(buffer_size, block_pool + i * blocks, blocks, assets[i].digits);
+        assets[i].stats = new (&stats_pool[i]) RollingStats();
+        assets[i].stats->begin(buffer_size, dc.ema_period, deque_pool + i * deque_bytes / sizeof(uint16_t));
+    }
+    for (int level = 0; level < ROLLUP_LEVELS; level++) {
+        for (int i = 0; i < num_assets && rollup_slots[level] > 0; i++) {
+            rollups[i][level].begin(rollup_periods[level], slot_pool, rollup_slots[level]);
+            slot_pool += rollup_slots[level];
+        }
     }
 }
 
 void initCrypto() {
 
-    // (WebPrefs already validates history_window: 1-24, price_update: 1-60)
+    // (WebPrefs already validates history_window: 1-168, price_update: 1-60)
     buffer_size = (dc.history_window * 60) / dc.price_update + 1;
-    
-    LOG_SINFO("Buffer size: %d entries (%d bytes per asset, %d total)",
-              buffer_size,
-              buffer_size * sizeof(float),
-              buffer_size * sizeof(float) * NUM_ASSETS);
     LOG_SINFO("Free heap before allocation: %d bytes", ESP.getFreeHeap());
 
-    assets[0] = {nullptr, 0.0f, 0.0f, dc.symbol1, dc.asset1, dc.digits1};
-    assets[1] = {nullptr, 0.0f, 0.0f, dc.symbol2, dc.asset2, dc.digits2};
-    assets[2] = {nullptr, 0.0f, 0.0f, dc.symbol3, dc.asset3, dc.digits3};
-    assets[3] = {nullptr, 0.0f, 0.0f, dc.symbol4, dc.asset4, dc.digits4};
+    parseAssetList();
+    // fetch metrics per symbol + the batch request
+    beginFetchMetrics(num_fetched + 1);
+    planRollups();
+    initArena();
 
-    // Allocate and initialize history buffers
-    for (int i = 0; i < NUM_ASSETS; i++) {
-        assets[i].price_buffer = new float[buffer_size]();
+    // log and backfill cover the raw history and the longest change window
+    history_samples = buffer_size;
+    for (int w = 0; w < num_change_windows; w++) {
+        history_samples = max(history_samples, change_windows[w].minutes / dc.price_update + 1);
     }
+    initHistoryLog(history_samples);
 
     LOG_SINFO("Free heap after allocation: %d bytes", ESP.getFreeHeap());
-    
-    // Fetch initial data
-    updatePrices();
-    // Calculate initial percentage changes
-    calculateChanges();     
+
+    // Initial data is fetched by the task right away
+    xTaskCreatePinnedToCore(fetchTask, "fetch", FETCH_TASK_STACK, nullptr, FETCH_TASK_PRIORITY, nullptr, FETCH_TASK_CORE);
 }
@@ -1,10 +1,52 @@
 #ifndef CRYPTO_H
 #define CRYPTO_H
 
+#include "display.h"
+
+// Fetch task runs on core 0, the render task on core 1
+#define FETCH_TASK_CORE      0
+#define FETCH_TASK_STACK     12288
+#define FETCH_TASK_PRIORITY  1
+#define FETCH_TASK_INTERVAL  100     // ms between stream/schedule checks
+#define SNAPSHOT_QUEUE_SIZE  32
+#define MARKET_QUEUE_SIZE    4       // market info is display only, an older update may be dropped
+
+// Rollup rings for change windows beyond the raw history
+#define ROLLUP_LEVELS               2
+#define CHANGE_WINDOW_MAX_MINUTES   (31 * 24 * 60)
+
+// Boot time backfill of the history from klines
+#define BACKFILL_CHUNK       480     // samples per kline request (weight 2)
+#define BACKFILL_BUFFER      1920    // samples of all assets buffered per chunk
+#define BACKFILL_KLINES_MAX  1500    // klines per request allowed by the exchange
+#define BACKFILL_TIMEOUT     60000   // ms, max. wait for the request budget
+
+enum SnapshotType : uint8_t {
+    SNAPSHOT_PRICES = 0,        // current prices
+    SNAPSHOT_SAMPLE,            // current prices of a price_update cycle, stored into the history
+    SNAPSHOT_BACKFILL,          // historical or logged sample, count = minutes since the previous sample
+    SNAPSHOT_BACKFILL_ROLLUP,   // historical sample older than the raw history, rollup rings only
+    SNAPSHOT_FILL               // repeat the newest history sample once
+};
+
+// Completed set of prices handed from the fetch task to the render task
+struct PriceSnapshot {
+    Price prices[MAX_ASSETS];   // 0 = no valid price for this asset
+    SnapshotType type;
+    uint16_t count;
+};
+
+// Mark price and funding of all fetched assets, published next to the price snapshots
+struct MarketSnapshot {
+    MarketInfo info[MAX_ASSETS];    // mark_price 0 = no update for this asset
+};
+
 void initCrypto();
 void updatePrices();
+int applyPriceSnapshots();
 void calculateChanges();
-float getOldPrice(int asset_index);
-float getBinancePrice(const char* symbol);
+Price getOldPrice(int asset_index);
+Price getBinancePrice(const char* symbol, MarketInfo &info);
+int getBinancePrices(Price* prices, MarketInfo* infos);
 
 #endif // CRYPTO_H
@@ -1,5 +1,347 @@
 #include "display.h"
 #include "globals.h"
+#include "metrics.h"
+#include "glyphatlas.h"
+#include <new>
+
+// Drawing target, the off-screen framebuffer if enabled, else the panel (render task only)
+static GFXcanvas16 *canvas = nullptr;
+static Adafruit_GFX *gfx = &tft;
+static ulong frame_start = 0;
+static uint32_t frame_lag = 0;
+
+// Previous frame while a transition runs, the new one is composed in the canvas
+static uint16_t *transition_from = nullptr;
+static bool transition_pending = false;
+
+// Text runs on the panel and of the frame being built, diffed cell by cell in endFrame()
+static TextRun shown_runs[TEXT_SLOTS];
+static TextRun frame_runs[TEXT_SLOTS];
+static DirtyRect dirty_rects[2 * TEXT_SLOTS];
+static int num_dirty = 0;
+
+/**
+ * Allocates the off-screen framebuffer, the panel is drawn directly if it does not fit
+ */
+static void initFramebuffer() {
+    if (!dc.framebuffer) {
+        return;
+    }
+    canvas = new (std::nothrow) GFXcanvas16(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (canvas == nullptr || canvas->getBuffer() == nullptr) {
+        LOG_SERROR("Framebuffer does not fit (%u bytes), drawing directly", SCREEN_WIDTH * SCREEN_HEIGHT * 2);
+        delete canvas;
+        canvas = nullptr;
+        return;
+    }
+    gfx = canvas;
+
+    // second frame for transitions
+    if (dc.transition != TRANSITION_CUT) {
+        transition_from = new (std::nothrow) uint16_t[SCREEN_WIDTH * SCREEN_HEIGHT];
+        if (transition_from == nullptr) {
+            LOG_SERROR("Transition buffer does not fit, hard cuts");
+        }
+    }
+    LOG_SINFO("Framebuffer: %u bytes%s, free heap: %u bytes", SCREEN_WIDTH * SCREEN_HEIGHT * 2,
+              (transition_from != nullptr) ? " x 2" : "", ESP.getFreeHeap());
+}
+
+/**
+ * @return true if frames are composed off-screen
+ */
+bool isFramebufferActive() {
+    return canvas != nullptr;
+}
+
+// ====================================================================================================
+// Text runs ==========================================================================================
+// ====================================================================================================
+/**
+ * Sets the text of a slot in the frame being built, drawn by endFrame() if it differs from the panel
+ *
+ * @param slot  Screen element
+ * @param x     Left edge
+ * @param y     Top edge
+ * @param size  GFX text size, cells are 6 x 8 pixels times size
+ * @param color Text color
+ * @param text  Text, truncated to TEXT_RUN_LENGTH - 1 characters
+ */
+static void setText(TextSlot slot, int x, int y, uint8_t size, uint16_t color, const char *text) {
+    TextRun &run = frame_runs[slot];
+    run.x = x;
+    run.y = y;
+    run.size = size;
+    run.color = color;
+    strlcpy(run.text, text, sizeof(run.text));
+}
+
+/**
+ * Removes all text of the frame being built, the next endFrame() erases what is not set again
+ */
+static void clearText() {
+    memset(frame_runs, 0, sizeof(frame_runs));
+}
+
+// pixel width of a text of the classic GFX font
+static int textWidth(const char *text, uint8_t size) {
+    return strlen(text) * 6 * size;
+}
+
+static uint16_t changeColor(float change) {
+    // Epsilon comparison for float
+    if (change < -0.001f) {
+        return RED;
+    }
+    return (change > 0.001f) ? GREEN : YELLOW_L;
+}
+
+/**
+ * Marks cells first .. last of a run as dirty, erased on the target and pushed after drawing
+ */
+static void addDirty(const TextRun &run, int first, int last) {
+    DirtyRect &rect = dirty_rects[num_dirty++];
+    rect.x = run.x + first * 6 * run.size;
+    rect.y = run.y;
+    rect.w = (last - first + 1) * 6 * run.size;
+    rect.h = 8 * run.size;
+    gfx->fillRect(rect.x, rect.y, rect.w, rect.h, BLACK);
+}
+
+/**
+ * Draws a character of size 2 or 3 from the glyph atlas, opaque on black
+ * The cell is expanded into a pixel buffer and sent as one address window (panel) or copied as
+ * row spans (framebuffer), instead of one fillRect per scaled font pixel.
+ *
+ * @return false if the atlas has no glyph for c at this size or the cell is not fully on screen
+ */
+static bool blitGlyph(int x, int y, char c, uint16_t color, uint8_t size) {
+    const uint32_t *rows = findGlyph(c, size);
+    int w = 6 * size;
+    int h = 8 * size;
+    if (rows == nullptr || x < 0 || y < 0 || y + h > SCREEN_HEIGHT || x >= SCREEN_WIDTH) {
+        return false;
+    }
+    // clip at the right edge, long prices may run off screen
+    int visible = min(w, SCREEN_WIDTH - x);
+
+    uint16_t pixels[GLYPH_MAX_WIDTH * GLYPH_MAX_HEIGHT];
+    uint16_t *p = pixels;
+    for (int r = 0; r < h; r++) {
+        uint32_t bits = rows[r];
+        for (int col = 0; col < visible; col++) {
+            *p++ = (bits & (1UL << (w - 1 - col))) ? color : BLACK;
+        }
+    }
+
+    if (canvas != nullptr) {
+        uint16_t *buffer = canvas->getBuffer();
+        for (int r = 0; r < h; r++) {
+            memcpy(buffer + (y + r) * SCREEN_WIDTH + x, pixels + r * visible, visible * sizeof(uint16_t));
+        }
+    } else {
+        tft.startWrite();
+        tft.setAddrWindow(x, y, visible, h);
+        tft.writePixels(pixels, visible * h);
+        tft.endWrite();
+    }
+    return true;
+}
+
+/**
+ * Pushes the dirty rectangles of the framebuffer to the panel, one address window each
+ *
+ * @return number of pixels sent
+ */
+static uint32_t flushDirty() {
+    uint32_t pixels = 0;
+    tft.startWrite();
+    for (int i = 0; i < num_dirty; i++) {
+        // clip to the screen, runs may extend beyond the right edge
+        const DirtyRect &rect = dirty_rects[i];
+        int x0 = max(0, (int)rect.x);
+        int y0 = max(0, (int)rect.y);
+        int x1 = min(SCREEN_WIDTH, rect.x + rect.w);
+        int y1 = min(SCREEN_HEIGHT, rect.y + rect.h);
+        if (x0 >= x1 || y0 >= y1) {
+            continue;
+        }
+        tft.setAddrWindow(x0, y0, x1 - x0, y1 - y0);
+        for (int y = y0; y < y1; y++) {
+            tft.writePixels(canvas->getBuffer() + y * SCREEN_WIDTH + x0, x1 - x0);
+        }
+        pixels += (x1 - x0) * (y1 - y0);
+    }
+    tft.endWrite();
+    return pixels;
+}
+
+/**
+ * Starts a frame, the display functions of the frame follow
+ * The text of the panel is kept, a full screen starts with clearText().
+ *
+ * @param lag_us Delay of the frame behind its due time, recorded with the frame
+ */
+void beginFrame(uint32_t lag_us) {
+    frame_start = micros();
+    frame_lag = lag_us;
+    memcpy(frame_runs, shown_runs, sizeof(frame_runs));
+}
+
+/**
+ * Completes a frame: only the character cells that differ from the panel are redrawn
+ * A run that moved is erased and redrawn completely. All erasing happens before drawing, so runs
+ * may swap places. With framebuffer, the changed cells are drawn in RAM and pushed as one address
+ * window per run. While a transition is pending, the frame stays in RAM. Render, flush time and
+ * pixels sent go to the metrics.
+ */
+void endFrame(FrameKind kind) {
+    int8_t draw_first[TEXT_SLOTS];
+    int8_t draw_last[TEXT_SLOTS];
+    num_dirty = 0;
+
+    // erase
+    for (int s = 0; s < TEXT_SLOTS; s++) {
+        const TextRun &old_run = shown_runs[s];
+        const TextRun &new_run = frame_runs[s];
+        int old_len = (old_run.size > 0) ? strlen(old_run.text) : 0;
+        int new_len = (new_run.size > 0) ? strlen(new_run.text) : 0;
+        draw_first[s] = -1;
+        draw_last[s] = -1;
+
+        if (old_run.size != new_run.size || old_run.x != new_run.x || old_run.y != new_run.y) {
+            if (old_len > 0) {
+                addDirty(old_run, 0, old_len - 1);
+            }
+            if (new_len > 0) {
+                draw_first[s] = 0;
+                draw_last[s] = new_len - 1;
+                addDirty(new_run, 0, new_len - 1);
+            }
+            continue;
+        }
+
+        int first = -1;
+        int last = -1;
+        for (int i = 0; i < max(old_len, new_len); i++) {
+            char old_char = (i < old_len) ? old_run.text[i] : ' ';
+            char new_char = (i < new_len) ? new_run.text[i] : ' ';
+            if (old_char != new_char || (new_char != ' ' && old_run.color != new_run.color)) {
+                first = (first < 0) ? i : first;
+                last = i;
+            }
+        }
+        if (first >= 0) {
+            draw_first[s] = first;
+            draw_last[s] = min(last, new_len - 1);
+            addDirty(new_run, first, last);
+        }
+    }
+
+    // draw
+    uint32_t pixels = 0;
+    for (int s = 0; s < TEXT_SLOTS; s++) {
+        const TextRun &run = frame_runs[s];
+        for (int i = draw_first[s]; i >= 0 && i <= draw_last[s]; i++) {
+            int x = run.x + i * 6 * run.size;
+            if (!blitGlyph(x, run.y, run.text[i], run.color, run.size)) {
+                gfx->drawChar(x, run.y, run.text[i], run.color, run.color, run.size);
+            }
+        }
+    }
+    memcpy(shown_runs, frame_runs, sizeof(shown_runs));
+
+    ulong flush_start = micros();
+    if (transition_pending) {
+        // pushed by renderTransition()
+    } else if (canvas != nullptr) {
+        pixels = flushDirty();
+    } else {
+        for (int i = 0; i < num_dirty; i++) {
+            pixels += dirty_rects[i].w * dirty_rects[i].h;
+        }
+    }
+    ulong flush_end = micros();
+    recordFrame(kind, flush_start - frame_start, (canvas != nullptr) ? flush_end - flush_start : 0, pixels, frame_lag);
+}
+
+// ====================================================================================================
+// Transitions ========================================================================================
+// ====================================================================================================
+// RGB565 blend, alpha 0-32 is the weight of b (all channels in one 32-bit multiply)
+static inline uint16_t blend565(uint16_t a, uint16_t b, uint32_t alpha) {
+    uint32_t a32 = (a | ((uint32_t)a << 16)) & 0x07E0F81F;
+    uint32_t b32 = (b | ((uint32_t)b << 16)) & 0x07E0F81F;
+    uint32_t mixed = ((a32 * (32 - alpha) + b32 * alpha) >> 5) & 0x07E0F81F;
+    return (uint16_t)(mixed | (mixed >> 16));
+}
+
+/**
+ * Keeps the current frame as start of a transition, the next frame is composed without being pushed
+ *
+ * @return false if transitions are off or have no buffer, the next frame is a hard cut
+ */
+bool beginTransition() {
+    if (transition_from == nullptr || dc.transition == TRANSITION_CUT) {
+        return false;
+    }
+    memcpy(transition_from, canvas->getBuffer(), SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t));
+    transition_pending = true;
+    return true;
+}
+
+/**
+ * Pushes one frame of the pending transition from the previous to the composed frame
+ * Rows are mixed into a line buffer and sent within one address window, no third frame buffer.
+ *
+ * @param progress 0 - 1, at 1 the panel shows the composed frame and the transition ends
+ * @param lag_us   Delay of the frame behind its due time
+ */
+void renderTransition(float progress, uint32_t lag_us) {
+    if (!transition_pending) {
+        return;
+    }
+    progress = constrain(progress, 0.0f, 1.0f);
+    const uint16_t *to = canvas->getBuffer();
+    uint16_t line[SCREEN_WIDTH];
+    int shift = (int)(progress * SCREEN_WIDTH);
+    uint32_t alpha = (uint32_t)(progress * 32.0f);
+    uint32_t mix_us = 0;
+
+    ulong start = micros();
+    tft.startWrite();
+    tft.setAddrWindow(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        ulong mix_start = micros();
+        const uint16_t *from_row = transition_from + y * SCREEN_WIDTH;
+        const uint16_t *to_row = to + y * SCREEN_WIDTH;
+        if (dc.transition == TRANSITION_SLIDE) {
+            // the new frame pushes the old one out to the left
+            memcpy(line, from_row + shift, (SCREEN_WIDTH - shift) * sizeof(uint16_t));
+            memcpy(line + SCREEN_WIDTH - shift, to_row, shift * sizeof(uint16_t));
+        } else {
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                line[x] = blend565(from_row[x], to_row[x], alpha);
+            }
+        }
+        mix_us += micros() - mix_start;
+        tft.writePixels(line, SCREEN_WIDTH);
+    }
+    tft.endWrite();
+    ulong total_us = micros() - start;
+
+    if (progress >= 1.0f) {
+        transition_pending = false;
+    }
+    recordFrame(FRAME_TRANSITION, mix_us, total_us - mix_us, SCREEN_WIDTH * SCREEN_HEIGHT, lag_us);
+}
+
+/**
+ * @return true while a transition has frames left
+ */
+bool isTransitionPending() {
+    return transition_pending;
+}
 
 void initDisplay(const char * hostip) {
     vspi.begin(SCLK_PIN, -1, DIN_PIN, -1);
@@ -14,71 +356,149 @@ void initDisplay(const char * hostip) {
     
     delay(3000);
 
+    // the text layer starts from an empty, unshifted panel
+    tft.fillScreen(BLACK);
+    setDisplayOffset(0);
+    initFramebuffer();
+
     // Display first asset
+    beginFrame(0);
     displayAsset(assets[0].asset_name, assets[0].current_price, assets[0].current_price,
-                 assets[0].digits, assets[0].change_percent, dc.x_offset, y_offset);
+                 assets[0].digits, assets[0].change_percent, assets[0].window_minutes, dc.x_offset);
+
+    displayChangeWindows(assets[0], dc.x_offset);
+    displayStats(assets[0], dc.x_offset);
+    displayMarketInfo(assets[0], dc.x_offset);
 
     // Display initial time
     displayDateTime();
+    endFrame(FRAME_ASSET);
 }
 
-void displayAsset(const char* symbol, float price, float old_price, int digits, float change, int x_offset, int y_offset) {
+void displayAsset(const char* symbol, Price price, Price old_price, int digits, float change,
+                  uint32_t window_minutes, int x_offset) {
 
     char text_buffer[40];
-    char fmt[10];
+    char separator = dc.thousands_sep ? ',' : '\0';
 
-    int16_t x1, y1;
-    uint16_t w, h;
-
-    tft.fillScreen(BLACK);
-    snprintf(fmt, sizeof(fmt), "%%.%df", digits);
+    clearText();
 
     // Symbol
-    tft.setTextSize(3);
-    tft.setTextColor(YELLOW_L);
-    tft.getTextBounds(symbol, 0, 0, &x1, &y1, &w, &h);
-    tft.setCursor(x_offset, 10 + y_offset);
-    tft.print(symbol);
+    setText(TEXT_SYMBOL, x_offset, 10, 3, YELLOW_L, symbol);
 
     // Store symbol width for positioning other elements
-    uint16_t symbol_width = w;
+    int symbol_width = textWidth(symbol, 3);
 
     if(dc.show_percent) {
-        // Epsilon comparison for float
-        if(change < -0.001f) {
-            tft.setTextColor(RED);
-        } else if(change > 0.001f) {
-            tft.setTextColor(GREEN);
-        } else {
-            tft.setTextColor(YELLOW_L);
-        }
         // History price window info
         if(dc.show_hw) {
-            sprintf(text_buffer, "%+.1f%% H%d", change, dc.history_window);
+            if (window_minutes > 1440 && window_minutes % 1440 == 0) {
+                sprintf(text_buffer, "%+.1f%% D%u", change, window_minutes / 1440);
+            } else if (window_minutes >= 60) {
+                sprintf(text_buffer, "%+.1f%% H%u", change, window_minutes / 60);
+            } else {
+                sprintf(text_buffer, "%+.1f%% M%u", change, window_minutes);
+            }
         } else {
             sprintf(text_buffer, "%+.1f%%", change);
         }
-        tft.setTextSize(1);
-        tft.setCursor(symbol_width + 5 + x_offset , 13 + y_offset);
-        tft.print(text_buffer);
+        setText(TEXT_PERCENT, symbol_width + 5 + x_offset, 13, 1, changeColor(change), text_buffer);
     }
 
     // History price
     if(dc.show_hp) {
-        sprintf(text_buffer, fmt, old_price);
-        tft.setTextColor(YELLOW_L);
-        tft.setTextSize(1);
-        tft.setCursor(symbol_width + 5 + x_offset , 23 + y_offset);
-        tft.print(text_buffer);
+        formatPrice(text_buffer, sizeof(text_buffer), old_price, digits, separator);
+        setText(TEXT_HISTORY, symbol_width + 5 + x_offset, 23, 1, YELLOW_L, text_buffer);
     }
 
     // Price
-    tft.setTextSize(2);
-    tft.setTextColor(YELLOW);
-    sprintf(text_buffer, fmt, price);
-    tft.getTextBounds(text_buffer, 0, 0, &x1, &y1, &w, &h);
-    tft.setCursor(x_offset, 40 + y_offset);
-    tft.print(text_buffer);
+    formatPrice(text_buffer, sizeof(text_buffer), price, digits, separator);
+    setText(TEXT_PRICE, x_offset, 40, 2, YELLOW, text_buffer);
+}
+
+/**
+ * Shows the changes of the configured windows below the price, two per line
+ */
+void displayChangeWindows(const AssetData &asset, int x_offset) {
+    if (!dc.show_windows) {
+        return;
+    }
+
+    char text_buffer[20];
+    for (int i = 0; i < num_change_windows; i++) {
+        float change = asset.window_change[i];
+        snprintf(text_buffer, sizeof(text_buffer), "%s%+.1f%%", change_windows[i].label, change);
+        setText((TextSlot)(TEXT_WINDOW + i), x_offset + (i % 2) * 62, 58 + (i / 2) * 8, 1,
+                changeColor(change), text_buffer);
+    }
+}
+
+/**
+ * Shows high/low, EMA and volatility of the history window below the time, two per line
+ */
+void displayStats(const AssetData &asset, int x_offset) {
+    if (!dc.show_stats || asset.stats == nullptr) {
+        return;
+    }
+
+    // label + price, no thousands separator in the narrow cells
+    char text_buffer[20];
+    const char labels[3] = { 'H', 'L', 'E' };
+    const Price values[3] = { asset.stats->high(), asset.stats->low(), priceFromFloat(asset.stats->ema()) };
+
+    for (int i = 0; i < 3; i++) {
+        text_buffer[0] = labels[i];
+        formatPrice(text_buffer + 1, sizeof(text_buffer) - 1, values[i], asset.digits, '\0');
+        setText((TextSlot)(TEXT_STATS + i), x_offset + (i % 2) * 62,
+                INFO_ROWS_Y + (i / 2) * INFO_ROW_HEIGHT, 1, YELLOW_L, text_buffer);
+    }
+    snprintf(text_buffer, sizeof(text_buffer), "V%.2f%%", asset.stats->volatility());
+    setText((TextSlot)(TEXT_STATS + 3), x_offset + 62, INFO_ROWS_Y + INFO_ROW_HEIGHT, 1,
+            YELLOW_L, text_buffer);
+}
+
+/**
+ * Shows mark price and funding rate with the time to the next funding below the statistics
+ * Synthetic assets have no market info, their rows stay empty.
+ */
+void displayMarketInfo(const AssetData &asset, int x_offset) {
+    if ((!dc.show_mark && !dc.show_funding) || asset.market.mark_price <= 0) {
+        return;
+    }
+
+    char text_buffer[24];
+    int y = INFO_ROWS_Y + (dc.show_stats ? 2 * INFO_ROW_HEIGHT : 0);
+
+    if (dc.show_mark) {
+        text_buffer[0] = 'M';
+        formatPrice(text_buffer + 1, sizeof(text_buffer) - 1, asset.market.mark_price, asset.digits,
+                    dc.thousands_sep ? ',' : '\0');
+        setText(TEXT_MARK, x_offset, y, 1, YELLOW_L, text_buffer);
+        y += INFO_ROW_HEIGHT;
+    }
+
+    if (dc.show_funding) {
+        float rate = asset.market.funding_rate * 100.0f;
+        int len = snprintf(text_buffer, sizeof(text_buffer), "F%+.4f%%", rate);
+
+        // countdown only with a synchronized clock
+        time_t now = time(nullptr);
+        if (asset.market.next_funding > (uint32_t)now && now > 1000000000L) {
+            uint32_t remaining = asset.market.next_funding - (uint32_t)now;
+            snprintf(text_buffer + len, sizeof(text_buffer) - len, " %luh%02lum",
+                     (ulong)(remaining / 3600), (ulong)(remaining % 3600 / 60));
+        }
+        uint16_t color = (rate < 0.0f) ? RED : (rate > 0.0f) ? GREEN : YELLOW_L;
+        setText(TEXT_FUNDING, x_offset, y, 1, color, text_buffer);
+    }
+}
+
+/**
+ * @return height of the enabled rows below the time, 0 if none are shown
+ */
+int infoRowsHeight() {
+    int rows = (dc.show_stats ? 2 : 0) + (dc.show_mark ? 1 : 0) + (dc.show_funding ? 1 : 0);
+    return (rows > 0) ? rows * INFO_ROW_HEIGHT + 4 : 0;
 }
 
 void displayDateTime() {
@@ -87,21 +507,21 @@ void displayDateTime() {
     }
 
     char time_str[20];
-    int16_t x1, y1;
-    uint16_t w, h;
 
     time_t now = time(nullptr);
     struct tm* timeinfo = localtime(&now);
     strftime(time_str, sizeof(time_str), "%d.%b %H:%M:%S", timeinfo);
 
-    tft.setTextSize(1);
-    tft.getTextBounds(time_str, 0, 0, &x1, &y1, &w, &h);
-
-    // Clear only the time display area (x, y, width, height)
-    tft.fillRect(dc.x_offset, 75 + y_offset, w, h, BLACK);
+    // usually only the seconds cells differ from the panel
+    setText(TEXT_TIME, dc.x_offset, 75, 1, LIGHTBLUE, time_str);
+}
 
-    // Draw updated time
-    tft.setTextColor(LIGHTBLUE);
-    tft.setCursor(dc.x_offset, 75 + y_offset);
-    tft.print(time_str);
+/**
+ * Shifts the whole image down by offset rows with the display start line register
+ * One command, no pixel data is sent and the drawing code keeps its unshifted coordinates. Rows shifted
+ * past the bottom wrap around to the top, the bounce range keeps the content clear of that.
+ */
+void setDisplayOffset(int offset) {
+    uint8_t line = (SCREEN_HEIGHT - constrain(offset, 0, SCREEN_HEIGHT - 1)) % SCREEN_HEIGHT;
+    tft.sendCommand(SSD1351_CMD_STARTLINE, &line, 1);
 }
@@ -5,6 +5,9 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1351.h>
 #include <SPI.h>
+#include "history.h"
+#include "stats.h"
+#include "price.h"
 
 // Display dimensions
 #define SCREEN_WIDTH  128
@@ -21,31 +24,109 @@
 #define BLUE       0x001F
 #define LIGHTBLUE  0x867D
 
+// Optional rows below the time (statistics, mark price, funding), the bounce range shrinks by them
+#define INFO_ROWS_Y      86
+#define INFO_ROW_HEIGHT  8
+
+// Additional change windows shown below the price
+#define CHANGE_WINDOWS_MAX 4
+
+// Frames are timed per kind: a full asset screen or the clock update in between
+enum FrameKind : uint8_t {
+    FRAME_ASSET = 0,
+    FRAME_CLOCK,
+    FRAME_TRANSITION,
+    FRAME_KINDS
+};
+
+// Asset change with framebuffer (transition setting)
+enum Transition : uint8_t {
+    TRANSITION_CUT = 0,
+    TRANSITION_SLIDE,
+    TRANSITION_FADE
+};
+
+// Text elements of the screen, each is one run of characters in one color and size
+#define TEXT_RUN_LENGTH 24
+
+enum TextSlot : uint8_t {
+    TEXT_SYMBOL = 0,
+    TEXT_PERCENT,
+    TEXT_HISTORY,
+    TEXT_PRICE,
+    TEXT_WINDOW,                                // one per change window
+    TEXT_TIME = TEXT_WINDOW + CHANGE_WINDOWS_MAX,
+    TEXT_STATS,                                 // high, low, EMA, volatility
+    TEXT_MARK = TEXT_STATS + 4,
+    TEXT_FUNDING,
+    TEXT_SLOTS
+};
+
+struct TextRun {
+    int16_t x;
+    int16_t y;
+    uint16_t color;
+    uint8_t size;                               // 0 = not shown
+    char text[TEXT_RUN_LENGTH];
+};
+
+struct DirtyRect {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+};
+
+struct ChangeWindow {
+    uint32_t minutes;
+    char label[8];      // e.g. "4h", "7d"
+};
+
+// Assets are configured at runtime (asset_list), up to MAX_ASSETS
+#define MAX_ASSETS          16
+#define ASSET_SYMBOL_LENGTH 17
+#define ASSET_NAME_LENGTH   7
+
 // Asset data structure
 struct AssetData {
-    float* price_buffer;
-    float current_price;
+    PriceHistory* history;
+    RollingStats* stats;
+    Price current_price;
+    MarketInfo market;                          // mark price and funding, fetched assets only
     float change_percent;
-    const char* symbol;
-    const char* asset_name;
+    uint32_t window_minutes;                    // span of change_percent, shorter if the history store ran out
+    char symbol[ASSET_SYMBOL_LENGTH];
+    char asset_name[ASSET_NAME_LENGTH];
     int digits;
+    Price window_price[CHANGE_WINDOWS_MAX];     // reference price per change window, 0 = not available
+    float window_change[CHANGE_WINDOWS_MAX];
 };
 
-// Number of assets
-#define NUM_ASSETS 4
-
 // External references
 extern SPIClass vspi;
 extern Adafruit_SSD1351 tft;
-extern AssetData assets[NUM_ASSETS];
-extern int buffer_index;
+extern AssetData assets[MAX_ASSETS];
+extern int num_assets;
+extern int num_fetched;             // assets[0 .. num_fetched - 1] are fetched, the rest is synthetic
 extern int buffer_size;
-extern bool buffer_full;
-extern int y_offset;
+extern ChangeWindow change_windows[CHANGE_WINDOWS_MAX];
+extern int num_change_windows;
 
 // Display functions
 void initDisplay(const char * hostip);
-void displayAsset(const char* symbol, float price, float old_price, int digits, float change, int x_offset, int y_offset);
+bool isFramebufferActive();
+void beginFrame(uint32_t lag_us);
+void endFrame(FrameKind kind);
+bool beginTransition();
+void renderTransition(float progress, uint32_t lag_us);
+bool isTransitionPending();
+void displayAsset(const char* symbol, Price price, Price old_price, int digits, float change,
+                  uint32_t window_minutes, int x_offset);
+void displayChangeWindows(const AssetData &asset, int x_offset);
+void displayStats(const AssetData &asset, int x_offset);
+void displayMarketInfo(const AssetData &asset, int x_offset);
+int infoRowsHeight();
 void displayDateTime();
+void setDisplayOffset(int offset);
 
 #endif // DISPLAY_H
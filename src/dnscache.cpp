@@ -0,0 +1,349 @@
+#include "globals.h"
+#include "dnscache.h"
+#include <WiFiUdp.h>
+
+#define DNS_PORT          53
+#define DNS_PACKET_SIZE   512
+#define DNS_HOST_LENGTH   64
+#define DNS_TYPE_A        1
+#define DNS_TYPE_CNAME    5
+
+// Resolved address of one host
+struct DnsEntry {
+    char host[DNS_HOST_LENGTH];
+    IPAddress ip;
+    ulong resolved_at;
+    ulong ttl;              // ms
+    ulong last_query;       // time the last query was sent
+    uint16_t query_id;      // id of the pending query, 0 = none
+    bool valid;
+};
+
+static DnsEntry cache[DNS_CACHE_SIZE];
+static DnsCacheStats stats;
+static WiFiUDP udp;
+static bool udp_open = false;
+static uint8_t packet[DNS_PACKET_SIZE];
+
+// ====================================================================================================
+// DNS messages (RFC 1035) ============================================================================
+// ====================================================================================================
+/**
+ * Sends an A query for the host of an entry to the DNS server of the WiFi connection
+ * The system resolver does not expose the record TTL, so the cache queries the server itself.
+ *
+ * @return true if the query was sent
+ */
+static bool sendQuery(DnsEntry &entry, ulong now) {
+    IPAddress server = WiFi.dnsIP(0);
+    if ((uint32_t)server == 0) {
+        return false;
+    }
+    if (!udp_open) {
+        udp_open = udp.begin(0);
+        if (!udp_open) {
+            return false;
+        }
+    }
+
+    uint16_t id = random(1, 0x10000);
+    memset(packet, 0, 12);
+    packet[0] = id >> 8;
+    packet[1] = id & 0xFF;
+    packet[2] = 0x01;       // recursion desired
+    packet[5] = 1;          // one question
+    size_t len = 12;
+
+    // QNAME: length prefixed labels
+    const char *label = entry.host;
+    while (*label != '\0') {
+        const char *dot = strchr(label, '.');
+        size_t n = (dot != nullptr) ? dot - label : strlen(label);
+        if (n == 0 || n > 63 || len + n + 6 > sizeof(packet)) {
+            return false;
+        }
+        packet[len++] = n;
+        memcpy(packet + len, label, n);
+        len += n;
+        label += (dot != nullptr) ? n + 1 : n;
+    }
+    packet[len++] = 0;
+    packet[len++] = 0;
+    packet[len++] = DNS_TYPE_A;
+    packet[len++] = 0;
+    packet[len++] = 1;      // class IN
+
+    entry.last_query = now;
+    if (!udp.beginPacket(server, DNS_PORT) || udp.write(packet, len) != len || !udp.endPacket()) {
+        return false;
+    }
+    entry.query_id = id;
+    return true;
+}
+
+/**
+ * @return position after a (possibly compressed) name, -1 if the packet is truncated
+ */
+static int skipName(int pos, int len) {
+    while (pos < len) {
+        uint8_t n = packet[pos];
+        if ((n & 0xC0) == 0xC0) {
+            return (pos + 2 <= len) ? pos + 2 : -1;
+        }
+        if (n == 0) {
+            return pos + 1;
+        }
+        pos += n + 1;
+    }
+    return -1;
+}
+
+static uint16_t read16(int pos) {
+    return (packet[pos] << 8) | packet[pos + 1];
+}
+
+/**
+ * Extracts the first A record of a response
+ *
+ * @param len Length of the response in packet
+ * @param ip  Resolved address
+ * @param ttl Shortest TTL of the CNAME/A chain in seconds
+ * @return true if an address was found
+ */
+static bool parseResponse(int len, IPAddress &ip, uint32_t &ttl) {
+    // response flag set, RCODE no error
+    if (len < 12 || !(packet[2] & 0x80) || (packet[3] & 0x0F) != 0) {
+        return false;
+    }
+    uint16_t questions = read16(4);
+    uint16_t answers = read16(6);
+
+    int pos = 12;
+    for (int i = 0; i < questions; i++) {
+        pos = skipName(pos, len);
+        if (pos < 0) {
+            return false;
+        }
+        pos += 4;   // QTYPE, QCLASS
+    }
+
+    bool found = false;
+    ttl = DNS_TTL_MAX;
+    for (int i = 0; i < answers; i++) {
+        pos = skipName(pos, len);
+        if (pos < 0 || pos + 10 > len) {
+            return false;
+        }
+        uint16_t type = read16(pos);
+        uint32_t record_ttl = ((uint32_t)read16(pos + 4) << 16) | read16(pos + 6);
+        uint16_t rdlength = read16(pos + 8);
+        pos += 10;
+        if (pos + rdlength > len) {
+            return false;
+        }
+
+        // the chain expires with its shortest record
+        if (type == DNS_TYPE_A || type == DNS_TYPE_CNAME) {
+            ttl = min(ttl, record_ttl);
+        }
+        if (type == DNS_TYPE_A && rdlength == 4 && !found) {
+            ip = IPAddress(packet[pos], packet[pos + 1], packet[pos + 2], packet[pos + 3]);
+            found = true;
+        }
+        pos += rdlength;
+    }
+    return found;
+}
+
+// ====================================================================================================
+// Cache ==============================================================================================
+// ====================================================================================================
+static DnsEntry *findEntry(const char *host) {
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        if (strcmp(cache[i].host, host) == 0) {
+            return &cache[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Takes a free entry or the one resolved longest ago
+ */
+static DnsEntry *allocEntry(const char *host) {
+    DnsEntry *entry = &cache[0];
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        if (cache[i].host[0] == '\0') {
+            entry = &cache[i];
+            break;
+        }
+        if ((long)(cache[i].resolved_at - entry->resolved_at) < 0) {
+            entry = &cache[i];
+        }
+    }
+    strlcpy(entry->host, host, sizeof(entry->host));
+    entry->valid = false;
+    entry->query_id = 0;
+    entry->last_query = 0;
+    return entry;
+}
+
+/**
+ * Reads all pending responses and updates the matching entries
+ */
+static void receiveResponses(ulong now) {
+    if (!udp_open) {
+        return;
+    }
+
+    while (udp.parsePacket() > 0) {
+        int len = udp.read(packet, sizeof(packet));
+        if (len < 12 || udp.remotePort() != DNS_PORT) {
+            continue;
+        }
+
+        uint16_t id = read16(0);
+        DnsEntry *entry = nullptr;
+        for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+            if (cache[i].query_id != 0 && cache[i].query_id == id) {
+                entry = &cache[i];
+            }
+        }
+        if (entry == nullptr) {
+            // late answer of a timed out query
+            continue;
+        }
+        entry->query_id = 0;
+
+        IPAddress ip;
+        uint32_t ttl;
+        if (!parseResponse(len, ip, ttl)) {
+            stats.failures++;
+            LOG_SERROR("DNS query for %s failed", entry->host);
+            continue;
+        }
+        if (entry->valid) {
+            stats.refreshes++;
+        }
+        entry->ip = ip;
+        entry->ttl = constrain(ttl, DNS_TTL_MIN, DNS_TTL_MAX) * 1000UL;
+        entry->resolved_at = now;
+        entry->valid = true;
+        LOG_SDEBUG("DNS %s -> %s, TTL %u s", entry->host, ip.toString().c_str(), ttl);
+    }
+}
+
+/**
+ * Starts a background refresh unless one is pending or the last one failed recently
+ */
+static void refreshEntry(DnsEntry &entry, ulong now) {
+    if (entry.query_id == 0 && (entry.last_query == 0 || now - entry.last_query >= DNS_RETRY_INTERVAL)) {
+        sendQuery(entry, now);
+    }
+}
+
+/**
+ * Resolves an entry and waits for the answer
+ */
+static bool queryBlocking(DnsEntry &entry) {
+    if (!sendQuery(entry, TIMENOW)) {
+        return false;
+    }
+    ulong start = TIMENOW;
+    while (entry.query_id != 0 && TIMENOW - start < DNS_QUERY_TIMEOUT) {
+        delay(5);
+        receiveResponses(TIMENOW);
+    }
+    if (entry.query_id != 0) {
+        entry.query_id = 0;
+        stats.failures++;
+        LOG_SERROR("DNS query for %s timed out", entry.host);
+    }
+    return entry.valid;
+}
+
+/**
+ * Resolves a host name through the cache
+ * Fresh addresses are served directly. Expired addresses are still served for up to DNS_STALE_MAX while
+ * a refresh runs in the background, only unknown hosts block on a lookup.
+ *
+ * @param host Host name or IP address string
+ * @param ip   Resolved address
+ * @return true if an address is available
+ */
+bool resolveHost(const char *host, IPAddress &ip) {
+    if (ip.fromString(host)) {
+        return true;
+    }
+
+    ulong now = TIMENOW;
+    receiveResponses(now);
+
+    DnsEntry *entry = findEntry(host);
+    if (entry != nullptr && entry->valid) {
+        ulong age = now - entry->resolved_at;
+        if (age < entry->ttl) {
+            stats.hits++;
+            ip = entry->ip;
+            return true;
+        }
+        if (age < entry->ttl + DNS_STALE_MAX * 1000UL) {
+            stats.stale_hits++;
+            refreshEntry(*entry, now);
+            ip = entry->ip;
+            return true;
+        }
+    }
+
+    stats.misses++;
+    if (entry == nullptr) {
+        entry = allocEntry(host);
+    }
+    entry->valid = false;
+    if (queryBlocking(*entry)) {
+        ip = entry->ip;
+        return true;
+    }
+
+    // fall back to the system resolver, TTL unknown
+    if (WiFi.hostByName(host, ip) == 1) {
+        entry->ip = ip;
+        entry->ttl = DNS_TTL_DEFAULT * 1000UL;
+        entry->resolved_at = TIMENOW;
+        entry->valid = true;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Expires the address of a host after a failed connection, the next lookup still serves it while
+ * it is refreshed in the background
+ */
+void invalidateHost(const char *host) {
+    DnsEntry *entry = findEntry(host);
+    if (entry != nullptr && entry->valid) {
+        entry->ttl = 0;
+        entry->last_query = 0;
+        refreshEntry(*entry, TIMENOW);
+    }
+}
+
+/**
+ * Collects background refresh answers and expires unanswered queries, call from the fetch task loop
+ */
+void handleDnsCache() {
+    ulong now = TIMENOW;
+    receiveResponses(now);
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        if (cache[i].query_id != 0 && now - cache[i].last_query >= DNS_QUERY_TIMEOUT) {
+            cache[i].query_id = 0;
+            stats.failures++;
+            LOG_SERROR("DNS refresh for %s timed out", cache[i].host);
+        }
+    }
+}
+
+const DnsCacheStats &getDnsCacheStats() {
+    return stats;
+}
@@ -0,0 +1,28 @@
+#ifndef DNSCACHE_H
+#define DNSCACHE_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+#define DNS_CACHE_SIZE     4          // cached host names
+#define DNS_TTL_MIN        30         // s, lower bound for the record TTL
+#define DNS_TTL_MAX        3600       // s, upper bound for the record TTL
+#define DNS_TTL_DEFAULT    300        // s, if the TTL is unknown (system resolver fallback)
+#define DNS_STALE_MAX      3600       // s, max. age past the TTL a stale address is still served
+#define DNS_QUERY_TIMEOUT  1000       // ms, per query
+#define DNS_RETRY_INTERVAL 10000      // ms, between failed background refreshes
+
+struct DnsCacheStats {
+    uint32_t hits;          // fresh address served
+    uint32_t stale_hits;    // expired address served while refreshing
+    uint32_t misses;        // blocking lookups
+    uint32_t refreshes;     // completed background refreshes
+    uint32_t failures;      // failed queries
+};
+
+bool resolveHost(const char *host, IPAddress &ip);
+void invalidateHost(const char *host);
+void handleDnsCache();
+const DnsCacheStats &getDnsCacheStats();
+
+#endif // DNSCACHE_H
@@ -0,0 +1,110 @@
+// Generated by glyphatlas.py, do not edit
+#include "glyphatlas.h"
+
+// " %+,-./0123456789:=ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+const int8_t glyph_index[128] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0, -1, -1, -1, -1,  1, -1, -1, -1, -1, -1,  2,  3,  4,  5,  6,
+     7,  8,  9, 10, 11, 12, 13, 14, 15, 16, 17, -1, -1, 18, -1, -1,
+    -1, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33,
+    34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+const uint32_t glyphs_2[GLYPH_COUNT][16] = {
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // ' '
+    { 0x00600, 0x00F00, 0x00F0C, 0x0061C, 0x00038, 0x00070, 0x000E0, 0x001C0, 0x00380, 0x00700, 0x00E18, 0x00C3C, 0x0003C, 0x00018, 0x00000, 0x00000 },  // '%'
+    { 0x00000, 0x00000, 0x000C0, 0x000C0, 0x000C0, 0x001E0, 0x00FFC, 0x00FFC, 0x001E0, 0x000C0, 0x000C0, 0x000C0, 0x00000, 0x00000, 0x00000, 0x00000 },  // '+'
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x000F0, 0x000F0, 0x000F0, 0x000F0, 0x000C0, 0x000C0, 0x00300, 0x00300 },  // ','
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00FFC, 0x00FFC, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // '-'
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x000F0, 0x000F0, 0x000F0, 0x000F0, 0x00000, 0x00000 },  // '.'
+    { 0x00000, 0x00000, 0x0000C, 0x0001C, 0x00038, 0x00070, 0x000E0, 0x001C0, 0x00380, 0x00700, 0x00E00, 0x00C00, 0x00000, 0x00000, 0x00000, 0x00000 },  // '/'
+    { 0x003F0, 0x003F0, 0x00C0C, 0x00C0C, 0x00C3C, 0x00C3C, 0x00CCC, 0x00CCC, 0x00F0C, 0x00F0C, 0x00C0C, 0x00C0C, 0x003F0, 0x003F0, 0x00000, 0x00000 },  // '0'
+    { 0x000C0, 0x000C0, 0x003C0, 0x003C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x003F0, 0x003F0, 0x00000, 0x00000 },  // '1'
+    { 0x003F0, 0x003F0, 0x00C0C, 0x00C0C, 0x0000C, 0x0000C, 0x003F0, 0x003F0, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00FFC, 0x00FFC, 0x00000, 0x00000 },  // '2'
+    { 0x00FFC, 0x00FFC, 0x0000C, 0x0000C, 0x00030, 0x00030, 0x000F0, 0x000F0, 0x0000C, 0x0000C, 0x00C0C, 0x00C0C, 0x003F0, 0x003F0, 0x00000, 0x00000 },  // '3'
+    { 0x00030, 0x00030, 0x000F0, 0x000F0, 0x00330, 0x00330, 0x00C30, 0x00C30, 0x00FFC, 0x00FFC, 0x00030, 0x00030, 0x00030, 0x00030, 0x00000, 0x00000 },  // '4'
+    { 0x00FFC, 0x00FFC, 0x00C00, 0x00C00, 0x00FF0, 0x00FF0, 0x0000C, 0x0000C, 0x0000C, 0x0000C, 0x00C0C, 0x00C0C, 0x003F0, 0x003F0, 0x00000, 0x00000 },  // '5'
+    { 0x000FC, 0x000FC, 0x00300, 0x00300, 0x00C00, 0x00C00, 0x00FF0, 0x00FF0, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x003F0, 0x003F0, 0x00000, 0x00000 },  // '6'
+    { 0x00FFC, 0x00FFC, 0x0000C, 0x0000C, 0x0000C, 0x0000C, 0x00030, 0x00030, 0x000C0, 0x000C0, 0x00300, 0x00300, 0x00C00, 0x00C00, 0x00000, 0x00000 },  // '7'
+    { 0x003F0, 0x003F0, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x003F0, 0x003F0, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x003F0, 0x003F0, 0x00000, 0x00000 },  // '8'
+    { 0x003F0, 0x003F0, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x003FC, 0x003FC, 0x0000C, 0x0000C, 0x00030, 0x00030, 0x00FC0, 0x00FC0, 0x00000, 0x00000 },  // '9'
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x000C0, 0x000C0, 0x00000, 0x00000, 0x000C0, 0x000C0, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // ':'
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00FFC, 0x00FFC, 0x00000, 0x00000, 0x00FFC, 0x00FFC, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // '='
+    { 0x000C0, 0x001E0, 0x00330, 0x00738, 0x00E1C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00FFC, 0x00FFC, 0x00E1C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00000, 0x00000 },  // 'A'
+    { 0x007F0, 0x00FF8, 0x00E1C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00FF0, 0x00FF0, 0x00E1C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00FF8, 0x007F0, 0x00000, 0x00000 },  // 'B'
+    { 0x003F0, 0x007F8, 0x00E1C, 0x00C0C, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C0C, 0x00E1C, 0x007F8, 0x003F0, 0x00000, 0x00000 },  // 'C'
+    { 0x007F0, 0x00FF8, 0x00E1C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00FF8, 0x007F0, 0x00000, 0x00000 },  // 'D'
+    { 0x007FC, 0x00FFC, 0x00E00, 0x00C00, 0x00C00, 0x00E00, 0x00FF0, 0x00FF0, 0x00E00, 0x00C00, 0x00C00, 0x00E00, 0x00FFC, 0x007FC, 0x00000, 0x00000 },  // 'E'
+    { 0x007FC, 0x00FFC, 0x00E00, 0x00C00, 0x00C00, 0x00E00, 0x00FF0, 0x00FF0, 0x00E00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00000, 0x00000 },  // 'F'
+    { 0x003F8, 0x007FC, 0x00E1C, 0x00C0C, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C38, 0x00C3C, 0x00C0C, 0x00E0C, 0x007FC, 0x003F8, 0x00000, 0x00000 },  // 'G'
+    { 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00FFC, 0x00FFC, 0x00E1C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00000, 0x00000 },  // 'H'
+    { 0x003F0, 0x003F0, 0x001E0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x001E0, 0x003F0, 0x003F0, 0x00000, 0x00000 },  // 'I'
+    { 0x000FC, 0x000FC, 0x00078, 0x00030, 0x00030, 0x00030, 0x00030, 0x00030, 0x00030, 0x00030, 0x00C30, 0x00E70, 0x007E0, 0x003C0, 0x00000, 0x00000 },  // 'J'
+    { 0x00C0C, 0x00C1C, 0x00C38, 0x00C70, 0x00CE0, 0x00CC0, 0x00F00, 0x00F00, 0x00CC0, 0x00CE0, 0x00C70, 0x00C38, 0x00C1C, 0x00C0C, 0x00000, 0x00000 },  // 'K'
+    { 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00E00, 0x00FFC, 0x007FC, 0x00000, 0x00000 },  // 'L'
+    { 0x00C0C, 0x00E1C, 0x00F3C, 0x00F3C, 0x00CCC, 0x00CCC, 0x00CCC, 0x00CCC, 0x00CCC, 0x00CCC, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00000, 0x00000 },  // 'M'
+    { 0x00C0C, 0x00C0C, 0x00C0C, 0x00E0C, 0x00F0C, 0x00F8C, 0x00CCC, 0x00CCC, 0x00C7C, 0x00C3C, 0x00C1C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00000, 0x00000 },  // 'N'
+    { 0x003F0, 0x007F8, 0x00E1C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00E1C, 0x007F8, 0x003F0, 0x00000, 0x00000 },  // 'O'
+    { 0x007F0, 0x00FF8, 0x00E1C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00FF8, 0x00FF0, 0x00E00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00C00, 0x00000, 0x00000 },  // 'P'
+    { 0x003F0, 0x007F8, 0x00E1C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00CCC, 0x00CCC, 0x00C30, 0x00E30, 0x007CC, 0x003CC, 0x00000, 0x00000 },  // 'Q'
+    { 0x007F0, 0x00FF8, 0x00E1C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00FF8, 0x00FF0, 0x00CC0, 0x00CC0, 0x00C70, 0x00C38, 0x00C1C, 0x00C0C, 0x00000, 0x00000 },  // 'R'
+    { 0x003F0, 0x007F8, 0x00E1C, 0x00C0C, 0x00C00, 0x00E00, 0x007F0, 0x003F8, 0x0001C, 0x0000C, 0x00C0C, 0x00E1C, 0x007F8, 0x003F0, 0x00000, 0x00000 },  // 'S'
+    { 0x007F8, 0x00FFC, 0x00CCC, 0x00CCC, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x00000, 0x00000 },  // 'T'
+    { 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00E1C, 0x007F8, 0x003F0, 0x00000, 0x00000 },  // 'U'
+    { 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00738, 0x00330, 0x001E0, 0x000C0, 0x00000, 0x00000 },  // 'V'
+    { 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00CCC, 0x00CCC, 0x00CCC, 0x00CCC, 0x00CCC, 0x00CCC, 0x00738, 0x00330, 0x00000, 0x00000 },  // 'W'
+    { 0x00C0C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00738, 0x00330, 0x000C0, 0x000C0, 0x00330, 0x00738, 0x00E1C, 0x00C0C, 0x00C0C, 0x00C0C, 0x00000, 0x00000 },  // 'X'
+    { 0x00C0C, 0x00C0C, 0x00C0C, 0x00E1C, 0x00738, 0x00330, 0x001E0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x000C0, 0x00000, 0x00000 },  // 'Y'
+    { 0x00FF8, 0x00FFC, 0x0000C, 0x0000C, 0x00038, 0x00070, 0x001F0, 0x003E0, 0x00380, 0x00700, 0x00C00, 0x00C00, 0x00FFC, 0x007FC, 0x00000, 0x00000 },  // 'Z'
+};
+
+const uint32_t glyphs_3[GLYPH_COUNT][24] = {
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // ' '
+    { 0x0C000, 0x1E000, 0x3F000, 0x3F038, 0x1E038, 0x0C078, 0x001E0, 0x001C0, 0x003C0, 0x00F00, 0x00E00, 0x01E00, 0x07800, 0x07000, 0x0F000, 0x3C060, 0x380F0, 0x381F8, 0x001F8, 0x000F0, 0x00060, 0x00000, 0x00000, 0x00000 },  // '%'
+    { 0x00000, 0x00000, 0x00000, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x01F00, 0x03F80, 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x03F80, 0x01F00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // '+'
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00FC0, 0x00FC0, 0x00FC0, 0x00FC0, 0x00FC0, 0x00FC0, 0x00E00, 0x00E00, 0x00E00, 0x07000, 0x07000, 0x07000 },  // ','
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // '-'
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00FC0, 0x00FC0, 0x00FC0, 0x00FC0, 0x00FC0, 0x00FC0, 0x00000, 0x00000, 0x00000 },  // '.'
+    { 0x00000, 0x00000, 0x00000, 0x00038, 0x00038, 0x00078, 0x001E0, 0x001C0, 0x003C0, 0x00F00, 0x00E00, 0x01E00, 0x07800, 0x07000, 0x0F000, 0x3C000, 0x38000, 0x38000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // '/'
+    { 0x07FC0, 0x07FC0, 0x07FC0, 0x38038, 0x38038, 0x38038, 0x381F8, 0x381F8, 0x381F8, 0x38E38, 0x38E38, 0x38E38, 0x3F038, 0x3F038, 0x3F038, 0x38038, 0x38038, 0x38038, 0x07FC0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // '0'
+    { 0x00E00, 0x00E00, 0x00E00, 0x07E00, 0x07E00, 0x07E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x07FC0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // '1'
+    { 0x07FC0, 0x07FC0, 0x07FC0, 0x38038, 0x38038, 0x38038, 0x00038, 0x00038, 0x00038, 0x07FC0, 0x07FC0, 0x07FC0, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x00000, 0x00000, 0x00000 },  // '2'
+    { 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x00038, 0x00038, 0x00038, 0x001C0, 0x001C0, 0x001C0, 0x00FC0, 0x00FC0, 0x00FC0, 0x00038, 0x00038, 0x00038, 0x38038, 0x38038, 0x38038, 0x07FC0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // '3'
+    { 0x001C0, 0x001C0, 0x001C0, 0x00FC0, 0x00FC0, 0x00FC0, 0x071C0, 0x071C0, 0x071C0, 0x381C0, 0x381C0, 0x381C0, 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x00000, 0x00000, 0x00000 },  // '4'
+    { 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x38000, 0x38000, 0x38000, 0x3FFC0, 0x3FFC0, 0x3FFC0, 0x00038, 0x00038, 0x00038, 0x00038, 0x00038, 0x00038, 0x38038, 0x38038, 0x38038, 0x07FC0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // '5'
+    { 0x00FF8, 0x00FF8, 0x00FF8, 0x07000, 0x07000, 0x07000, 0x38000, 0x38000, 0x38000, 0x3FFC0, 0x3FFC0, 0x3FFC0, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x07FC0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // '6'
+    { 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x00038, 0x00038, 0x00038, 0x00038, 0x00038, 0x00038, 0x001C0, 0x001C0, 0x001C0, 0x00E00, 0x00E00, 0x00E00, 0x07000, 0x07000, 0x07000, 0x38000, 0x38000, 0x38000, 0x00000, 0x00000, 0x00000 },  // '7'
+    { 0x07FC0, 0x07FC0, 0x07FC0, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x07FC0, 0x07FC0, 0x07FC0, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x07FC0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // '8'
+    { 0x07FC0, 0x07FC0, 0x07FC0, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x07FF8, 0x07FF8, 0x07FF8, 0x00038, 0x00038, 0x00038, 0x001C0, 0x001C0, 0x001C0, 0x3FE00, 0x3FE00, 0x3FE00, 0x00000, 0x00000, 0x00000 },  // '9'
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00E00, 0x00E00, 0x00E00, 0x00000, 0x00000, 0x00000, 0x00E00, 0x00E00, 0x00E00, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // ':'
+    { 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x00000, 0x00000, 0x00000, 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000 },  // '='
+    { 0x00E00, 0x00E00, 0x01F00, 0x071C0, 0x071C0, 0x0F1E0, 0x3C078, 0x3C078, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x38038, 0x38038, 0x00000, 0x00000, 0x00000 },  // 'A'
+    { 0x0FFC0, 0x1FFC0, 0x3FFE0, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x3FFC0, 0x3FFC0, 0x3FFC0, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x3FFE0, 0x1FFC0, 0x0FFC0, 0x00000, 0x00000, 0x00000 },  // 'B'
+    { 0x07FC0, 0x07FC0, 0x0FFE0, 0x3E0F8, 0x3C038, 0x38038, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38038, 0x3C038, 0x3E0F8, 0x0FFE0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // 'C'
+    { 0x0FFC0, 0x1FFC0, 0x3FFE0, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x3FFE0, 0x1FFC0, 0x0FFC0, 0x00000, 0x00000, 0x00000 },  // 'D'
+    { 0x0FFF8, 0x1FFF8, 0x3FFF8, 0x3E000, 0x3C000, 0x38000, 0x38000, 0x3C000, 0x3E000, 0x3FFC0, 0x3FFC0, 0x3FFC0, 0x3E000, 0x3C000, 0x38000, 0x38000, 0x3C000, 0x3E000, 0x3FFF8, 0x1FFF8, 0x0FFF8, 0x00000, 0x00000, 0x00000 },  // 'E'
+    { 0x0FFF8, 0x1FFF8, 0x3FFF8, 0x3E000, 0x3C000, 0x38000, 0x38000, 0x3C000, 0x3E000, 0x3FFC0, 0x3FFC0, 0x3FFC0, 0x3E000, 0x3C000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x00000, 0x00000, 0x00000 },  // 'F'
+    { 0x07FE0, 0x07FF0, 0x0FFF8, 0x3E0F8, 0x3C038, 0x38038, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x381E0, 0x381F0, 0x381F8, 0x38038, 0x3C038, 0x3E038, 0x0FFF8, 0x07FF0, 0x07FE0, 0x00000, 0x00000, 0x00000 },  // 'G'
+    { 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x3FFF8, 0x3FFF8, 0x3FFF8, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x00000, 0x00000, 0x00000 },  // 'H'
+    { 0x07FC0, 0x07FC0, 0x07FC0, 0x01F00, 0x01F00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x01F00, 0x01F00, 0x07FC0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // 'I'
+    { 0x00FF8, 0x00FF8, 0x00FF8, 0x003E0, 0x003E0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x001C0, 0x381C0, 0x383C0, 0x3E7C0, 0x0FF00, 0x07E00, 0x07E00, 0x00000, 0x00000, 0x00000 },  // 'J'
+    { 0x38038, 0x38038, 0x38078, 0x381E0, 0x381C0, 0x383C0, 0x38F00, 0x38E00, 0x38E00, 0x3F000, 0x3F000, 0x3F000, 0x38E00, 0x38E00, 0x38F00, 0x383C0, 0x381C0, 0x381E0, 0x38078, 0x38038, 0x38038, 0x00000, 0x00000, 0x00000 },  // 'K'
+    { 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x3C000, 0x3E000, 0x3FFF8, 0x1FFF8, 0x0FFF8, 0x00000, 0x00000, 0x00000 },  // 'L'
+    { 0x38038, 0x38038, 0x3C078, 0x3F1F8, 0x3F1F8, 0x3F1F8, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x00000, 0x00000, 0x00000 },  // 'M'
+    { 0x38038, 0x38038, 0x38038, 0x38038, 0x3C038, 0x3C038, 0x3F038, 0x3F038, 0x3F838, 0x38E38, 0x38E38, 0x38E38, 0x383F8, 0x381F8, 0x381F8, 0x38078, 0x38078, 0x38038, 0x38038, 0x38038, 0x38038, 0x00000, 0x00000, 0x00000 },  // 'N'
+    { 0x07FC0, 0x07FC0, 0x0FFE0, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x0FFE0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // 'O'
+    { 0x0FFC0, 0x1FFC0, 0x3FFE0, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x3FFE0, 0x3FFC0, 0x3FFC0, 0x3E000, 0x3C000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x38000, 0x00000, 0x00000, 0x00000 },  // 'P'
+    { 0x07FC0, 0x07FC0, 0x0FFE0, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38E38, 0x38E38, 0x38E38, 0x381C0, 0x3C1C0, 0x3E1C0, 0x0FE38, 0x07E38, 0x07E38, 0x00000, 0x00000, 0x00000 },  // 'Q'
+    { 0x0FFC0, 0x1FFC0, 0x3FFE0, 0x3E0F8, 0x3C078, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x3FFE0, 0x3FFC0, 0x3FFC0, 0x38E00, 0x38E00, 0x38E00, 0x383C0, 0x381C0, 0x381E0, 0x38078, 0x38038, 0x38038, 0x00000, 0x00000, 0x00000 },  // 'R'
+    { 0x07FC0, 0x07FC0, 0x0FFE0, 0x3E0F8, 0x3C038, 0x38038, 0x38000, 0x3C000, 0x3E000, 0x0FFC0, 0x07FC0, 0x07FE0, 0x000F8, 0x00078, 0x00038, 0x38038, 0x38078, 0x3E0F8, 0x0FFE0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // 'S'
+    { 0x0FFE0, 0x1FFF0, 0x3FFF8, 0x38E38, 0x38E38, 0x38E38, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00000, 0x00000, 0x00000 },  // 'T'
+    { 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x3C078, 0x3E0F8, 0x0FFE0, 0x07FC0, 0x07FC0, 0x00000, 0x00000, 0x00000 },  // 'U'
+    { 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x3C078, 0x3C078, 0x0F1E0, 0x071C0, 0x071C0, 0x01F00, 0x00E00, 0x00E00, 0x00000, 0x00000, 0x00000 },  // 'V'
+    { 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38038, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x38E38, 0x0F1E0, 0x071C0, 0x071C0, 0x00000, 0x00000, 0x00000 },  // 'W'
+    { 0x38038, 0x38038, 0x38038, 0x38038, 0x3C078, 0x3C078, 0x0F1E0, 0x071C0, 0x071C0, 0x00E00, 0x00E00, 0x00E00, 0x071C0, 0x071C0, 0x0F1E0, 0x3C078, 0x3C078, 0x38038, 0x38038, 0x38038, 0x38038, 0x00000, 0x00000, 0x00000 },  // 'X'
+    { 0x38038, 0x38038, 0x38038, 0x38038, 0x3C078, 0x3C078, 0x0F1E0, 0x071C0, 0x071C0, 0x01F00, 0x01F00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00E00, 0x00000, 0x00000, 0x00000 },  // 'Y'
+    { 0x3FFE0, 0x3FFF0, 0x3FFF8, 0x00038, 0x00038, 0x00038, 0x001E0, 0x001E0, 0x007C0, 0x01FC0, 0x03F80, 0x07F00, 0x07C00, 0x0F000, 0x0F000, 0x38000, 0x38000, 0x38000, 0x3FFF8, 0x1FFF8, 0x0FFF8, 0x00000, 0x00000, 0x00000 },  // 'Z'
+};
@@ -0,0 +1,27 @@
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <Arduino.h>
+
+// Pre-rasterized text sizes 2 and 3 of the GFX font, generated by glyphatlas.py
+// Rows are bit masks, the leftmost pixel is the highest bit of the cell width (6 x size).
+#define GLYPH_COUNT       45
+#define GLYPH_MAX_WIDTH   18
+#define GLYPH_MAX_HEIGHT  24
+
+extern const int8_t glyph_index[128];
+extern const uint32_t glyphs_2[GLYPH_COUNT][16];
+extern const uint32_t glyphs_3[GLYPH_COUNT][24];
+
+/**
+ * @return rows of the glyph (8 x size), nullptr if the atlas has no glyph for c at this size
+ */
+inline const uint32_t *findGlyph(char c, uint8_t size) {
+    int8_t index = ((uint8_t)c < 128) ? glyph_index[(uint8_t)c] : -1;
+    if (index < 0) {
+        return nullptr;
+    }
+    return (size == 2) ? glyphs_2[index] : (size == 3) ? glyphs_3[index] : nullptr;
+}
+
+#endif // GLYPHATLAS_H
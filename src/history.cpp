@@ -0,0 +1,281 @@
+#include "globals.h"
+#include "history.h"
+#include <new>
+
+#define HISTORY_FIXED_MAX  1000000000L   // keeps deltas within int32
+
+#define HISTORY_STEP_MAX   100000000000000000LL   // 10^17, the coarsest step (10^-9 decimals)
+
+static inline uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static size_t writeVarint(uint32_t value, uint8_t *out) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = value;
+    return n;
+}
+
+static uint32_t readVarint(const uint8_t *data, uint8_t &pos) {
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    uint8_t byte;
+    do {
+        byte = data[pos++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+/**
+ * Number of blocks needed for a window at the expected compression
+ */
+uint16_t PriceHistory::blocksFor(uint32_t window_samples) {
+    uint32_t bytes = window_samples * HISTORY_BYTES_PER_SAMPLE;
+    uint32_t count = (bytes + sizeof(HistoryBlock::data) - 1) / sizeof(HistoryBlock::data) + 2;
+    return (count > UINT16_MAX) ? UINT16_MAX : count;
+}
+
+/**
+ * Attaches the block pool, the memory is owned by the caller (asset arena)
+ *
+ * @param window_samples Samples kept in the window
+ * @param pool           Block pool
+ * @param _block_count   Blocks in the pool, see blocksFor()
+ * @param _digits        Decimals of the asset, the step of the fixed-point values
+ * @return false if there is no pool
+ */
+bool PriceHistory::begin(uint32_t window_samples, HistoryBlock *pool, uint16_t _block_count, int _digits) {
+    if (pool == nullptr || _block_count == 0) {
+        blocks = nullptr;
+        block_count = 0;
+        return false;
+    }
+    blocks = pool;
+    block_count = _block_count;
+    window = window_samples;
+    used = 0;
+    head = block_count - 1;
+    total = 0;
+    last = 0;
+    step = 0;
+    digits = _digits;
+    oldest_value = 0;
+    shortened = false;
+    return true;
+}
+
+/**
+ * Appends a sample, the oldest one beyond the window is dropped implicitly
+ */
+void PriceHistory::push(Price price) {
+    if (blocks == nullptr) {
+        return;
+    }
+
+    // steps of the displayed decimals (2: 0.01), coarser only if the first price leaves less than 10x headroom
+    if (step == 0 && price > 0) {
+        int decimals = digits;
+        step = 1;
+        for (int i = decimals; i < PRICE_DECIMALS; i++) {
+            step *= 10;
+        }
+        while (step < HISTORY_STEP_MAX && price / step > HISTORY_FIXED_MAX / 10) {
+            step *= 10;
+            decimals--;
+        }
+        if (decimals < digits) {
+            LOG_SINFO("History keeps %d instead of %d decimals for %.2f", decimals, digits, priceToFloat(price));
+        }
+    }
+    int32_t value = 0;
+    if (step > 0) {
+        // integer rounding to the nearest step, exact for every price
+        Price fixed = (price + ((price < 0) ? -step / 2 : step / 2)) / step;
+        value = (int32_t)constrain(fixed, -(Price)HISTORY_FIXED_MAX, (Price)HISTORY_FIXED_MAX);
+    }
+
+    if (used == 0) {
+        newBlock(value);
+    } else {
+        HistoryBlock &block = blocks[head];
+        uint8_t encoded[5];
+        size_t n = writeVarint(zigzag(value - last), encoded);
+        if (block.count == UINT8_MAX || block.len + n > sizeof(block.data)) {
+            newBlock(value);
+        } else {
+            memcpy(block.data + block.len, encoded, n);
+            block.len += n;
+            block.count++;
+        }
+    }
+    last = value;
+    total++;
+
+    // cached, the render task reads it on every pass
+    uint32_t first = firstSequence();
+    oldest_value = decode(*findBlock(first), first);
+}
+
+/**
+ * @param index 0 = oldest sample of the window
+ * @return price, 0 if not available
+ */
+Price PriceHistory::get(uint32_t index) const {
+    uint32_t sequence = firstSequence() + index;
+    if (used == 0 || sequence >= total) {
+        return 0;
+    }
+    const HistoryBlock *block = findBlock(sequence);
+    return (Price)decode(*block, sequence) * step;
+}
+
+/**
+ * @return samples available in the window
+ */
+uint32_t PriceHistory::size() const {
+    return total - firstSequence();
+}
+
+/**
+ * Sequence number of the oldest sample in the window
+ */
+uint32_t PriceHistory::firstSequence() const {
+    if (used == 0) {
+        return total;
+    }
+    uint32_t window_start = (total > window) ? total - window : 0;
+    uint32_t stored_start = blocks[(head + block_count - used + 1) % block_count].first;
+    return max(window_start, stored_start);
+}
+
+/**
+ * Binary search for the block holding a sample
+ */
+const HistoryBlock *PriceHistory::findBlock(uint32_t sequence) const {
+    uint16_t tail = (head + block_count - used + 1) % block_count;
+    uint16_t low = 0;
+    uint16_t high = used - 1;
+    while (low < high) {
+        uint16_t mid = (low + high + 1) / 2;
+        if (blocks[(tail + mid) % block_count].first <= sequence) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return &blocks[(tail + low) % block_count];
+}
+
+int32_t PriceHistory::decode(const HistoryBlock &block, uint32_t sequence) const {
+    int32_t value = block.base;
+    uint8_t pos = 0;
+    for (uint32_t i = block.first; i < sequence; i++) {
+        value += unzigzag(readVarint(block.data, pos));
+    }
+    return value;
+}
+
+/**
+ * Starts a new block, reuses the oldest one if the pool is exhausted
+ */
+void PriceHistory::newBlock(int32_t value) {
+    head = (head + 1) % block_count;
+    if (used == block_count) {
+        // the dropped block is still part of the window
+        HistoryBlock &dropped = blocks[head];
+        uint32_t window_start = (total + 1 > window) ? total + 1 - window : 0;
+        if (!shortened && dropped.first + dropped.count > window_start) {
+            shortened = true;
+            LOG_SINFO("History store full, window shortened to %u samples", total + 1 - dropped.first - dropped.count);
+        }
+    } else {
+        used++;
+    }
+
+    HistoryBlock &block = blocks[head];
+    block.first = total;
+    block.base = value;
+    block.count = 1;
+    block.len = 0;
+}
+
+// ====================================================================================================
+// RollupRing =========================================================================================
+// ====================================================================================================
+/**
+ * @param period_minutes Minutes per slot
+ * @param storage        Slot memory, owned by the caller (asset arena)
+ * @param slot_count     Slots, covers (slot_count - 1) periods
+ * @return false if there is no slot memory
+ */
+bool RollupRing::begin(uint16_t period_minutes, Price *storage, uint16_t slot_count) {
+    if (storage == nullptr || slot_count == 0) {
+        prices = nullptr;
+        slots = 0;
+        return false;
+    }
+    prices = storage;
+    memset(prices, 0, sizeof(Price) * slot_count);
+    period = period_minutes;
+    slots = slot_count;
+    count = 0;
+    head = slot_count - 1;
+    last_period = 0;
+    last_price = 0;
+    return true;
+}
+
+/**
+ * @param price  Sampled price
+ * @param minute Minutes since the first sample
+ */
+void RollupRing::update(Price price, uint32_t minute) {
+    if (prices == nullptr) {
+        return;
+    }
+    uint32_t number = minute / period;
+    if (count > 0 && number == last_period) {
+        last_price = price;
+        return;
+    }
+
+    // periods without samples (price_update > period) keep the previous price
+    uint32_t steps = (count == 0) ? 1 : min(number - last_period, (uint32_t)slots);
+    for (uint32_t i = 1; i <= steps; i++) {
+        head = (head + 1) % slots;
+        prices[head] = (i < steps) ? last_price : price;
+        if (count < slots) {
+            count++;
+        }
+    }
+    last_period = number;
+    last_price = price;
+}
+
+/**
+ * Price at the start of the period containing a minute, the oldest price if it is out of range
+ *
+ * @param minute Minutes since the first sample
+ * @return price, 0 if empty
+ */
+Price RollupRing::at(uint32_t minute) const {
+    if (prices == nullptr || count == 0) {
+        return 0;
+    }
+    uint32_t number = minute / period;
+    uint32_t back = (number < last_period) ? last_period - number : 0;
+    if (back >= count) {
+        back = count - 1;
+    }
+    return prices[(head + slots - back) % slots];
+}
@@ -0,0 +1,82 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <Arduino.h>
+#include "price.h"
+
+#define HISTORY_BLOCK_SIZE         64        // bytes per block incl. header
+#define HISTORY_BYTES_PER_SAMPLE   3         // sizes the block pool: deltas up to +/-2^20 steps per sample
+
+// Block of delta encoded samples: fixed-point base followed by zigzag varint deltas to the previous sample
+struct HistoryBlock {
+    uint32_t first;     // sequence number of the first sample
+    int32_t base;       // first sample (fixed-point)
+    uint8_t count;      // samples in this block
+    uint8_t len;        // used bytes of data
+    uint8_t data[HISTORY_BLOCK_SIZE - 10];
+};
+
+/**
+ * Compressed rolling price history
+ * Prices are stored as fixed-point values with the decimals of the asset (coarser only if the first
+ * valid price leaves less than 10x headroom) in a ring of fixed-size blocks and read back as exact Price
+ * values. A block is closed when its next delta does not fit, so quiet markets pack more samples per
+ * block. If the pool runs out of blocks (larger deltas than it is sized for), the oldest block is
+ * dropped and span() gets shorter.
+ */
+class PriceHistory {
+  public:
+    bool begin(uint32_t window_samples, HistoryBlock *pool, uint16_t block_count, int digits);
+    void push(Price price);
+    Price get(uint32_t index) const;
+    Price oldest() const { return (Price)oldest_value * step; }
+    Price newest() const { return (Price)last * step; }
+    uint32_t size() const;
+    bool full() const { return size() >= window; }
+    uint32_t span() const { return shortened ? size() : window; }
+    size_t memoryUsage() const { return block_count * sizeof(HistoryBlock); }
+
+    static uint16_t blocksFor(uint32_t window_samples);
+
+  private:
+    HistoryBlock *blocks = nullptr;
+    uint16_t block_count = 0;
+    uint16_t used = 0;          // blocks in use
+    uint16_t head = 0;          // newest block
+    uint32_t window = 0;        // samples kept
+    uint32_t total = 0;         // samples pushed
+    int32_t last = 0;           // newest sample (fixed-point)
+    Price step = 0;             // Price value of one fixed-point step, 0 = no valid price yet
+    int digits = 0;             // decimals of the asset
+    int32_t oldest_value = 0;   // oldest sample of the window (fixed-point)
+    bool shortened = false;
+
+    uint32_t firstSequence() const;
+    const HistoryBlock *findBlock(uint32_t sequence) const;
+    int32_t decode(const HistoryBlock &block, uint32_t sequence) const;
+    void newBlock(int32_t value);
+};
+
+/**
+ * Rollup ring: price at the start of each fixed period (e.g. every 5 min or every hour)
+ * Fed with every history sample, a new slot is written when a sample opens a new period.
+ */
+class RollupRing {
+  public:
+    bool begin(uint16_t period_minutes, Price *storage, uint16_t slot_count);
+    void update(Price price, uint32_t minute);
+    Price at(uint32_t minute) const;
+    uint32_t coverage() const { return (uint32_t)period * (slots - 1); }
+    bool active() const { return prices != nullptr; }
+
+  private:
+    Price *prices = nullptr;
+    uint16_t period = 0;        // minutes
+    uint16_t slots = 0;
+    uint16_t count = 0;
+    uint16_t head = 0;          // newest slot
+    uint32_t last_period = 0;   // period number of the newest slot
+    Price last_price = 0;       // latest sample
+};
+
+#endif // HISTORY_H
@@ -0,0 +1,321 @@
+#include "globals.h"
+#include "historylog.h"
+#include "storage.h"
+#include <LittleFS.h>
+
+#define HISTORY_LOG_MAGIC    0x474F4C48     // "HLOG"
+#define HISTORY_LOG_VERSION  2         // 2: prices as Price instead of float
+
+// Written at the start of every segment, segments of another configuration are not replayed
+struct LogHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t price_update;
+    uint16_t config_hash;
+    uint16_t assets;
+};
+
+static LogHeader header;
+static bool log_ready = false;
+static uint32_t window_samples = 0;
+static uint32_t first_segment = 0;      // oldest segment number, 0 = no segments
+static uint32_t last_segment = 0;       // segment appended to
+static size_t segment_size = 0;
+static uint16_t max_segments = 0;
+
+// records are stored packed, the time and the prices of the configured assets only
+static size_t record_size = 0;
+static uint8_t batch[HISTORY_LOG_BATCH * sizeof(HistoryRecord)];
+static uint8_t batch_count = 0;
+static SemaphoreHandle_t log_mutex = nullptr;
+
+/**
+ * Unpacks a stored record, the prices of a packed record are not aligned
+ */
+static void readRecord(const uint8_t *data, HistoryRecord &record) {
+    memcpy(&record.time, data, sizeof(record.time));
+    memcpy(record.prices, data + sizeof(record.time), num_assets * sizeof(Price));
+}
+
+static void segmentPath(uint32_t number, char *path, size_t size) {
+    snprintf(path, size, HISTORY_LOG_DIR "/%08u.log", number);
+}
+
+/**
+ * Checksum of the settings that define the meaning of a record
+ */
+static uint16_t configHash() {
+    char buffer[MAX_ASSETS * ASSET_SYMBOL_LENGTH + 8];
+    int len = 0;
+    for (int i = 0; i < num_assets; i++) {
+        len += snprintf(buffer + len, sizeof(buffer) - len, "%s,", assets[i].symbol);
+    }
+    len += snprintf(buffer + len, sizeof(buffer) - len, "%u", dc.price_update);
+    return computeChecksum((const uint8_t *)buffer, len);
+}
+
+static bool readHeader(File &file) {
+    LogHeader segment_header;
+    return file.read((uint8_t *)&segment_header, sizeof(segment_header)) == sizeof(segment_header)
+        && memcmp(&segment_header, &header, sizeof(header)) == 0;
+}
+
+static void removeSegments() {
+    char path[32];
+    for (uint32_t number = first_segment; number != 0 && number <= last_segment; number++) {
+        segmentPath(number, path, sizeof(path));
+        LittleFS.remove(path);
+    }
+    first_segment = 0;
+    last_segment = 0;
+    segment_size = 0;
+}
+
+/**
+ * Opens a new segment and drops the oldest ones that are no longer needed for the window
+ */
+static bool startSegment() {
+    char path[32];
+    segmentPath(last_segment + 1, path, sizeof(path));
+    File file = LittleFS.open(path, "w");
+    if (!file) {
+        return false;
+    }
+    bool written = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+    file.close();
+    if (!written) {
+        return false;
+    }
+
+    last_segment++;
+    if (first_segment == 0) {
+        first_segment = last_segment;
+    }
+    segment_size = sizeof(header);
+
+    while (last_segment - first_segment + 1 > max_segments) {
+        segmentPath(first_segment++, path, sizeof(path));
+        LittleFS.remove(path);
+    }
+    return true;
+}
+
+/**
+ * Appends the buffered records to the current segment (caller holds log_mutex)
+ */
+static void writeBatch() {
+    if (batch_count == 0) {
+        return;
+    }
+
+    size_t bytes = batch_count * record_size;
+    batch_count = 0;
+    if ((last_segment == 0 || segment_size + bytes > HISTORY_LOG_SEGMENT) && !startSegment()) {
+        LOG_SERROR("History log: cannot create segment");
+        return;
+    }
+
+    char path[32];
+    segmentPath(last_segment, path, sizeof(path));
+    File file = LittleFS.open(path, "a");
+    if (!file || file.write(batch, bytes) != bytes) {
+        LOG_SERROR("History log: write failed");
+    }
+    file.close();
+    segment_size += bytes;
+}
+
+/**
+ * Mounts LittleFS and finds the segments of the history log
+ *
+ * @param _window_samples Samples the log has to cover
+ * @return false if the file system is not available
+ */
+bool initHistoryLog(uint32_t _window_samples) {
+    log_mutex = xSemaphoreCreateMutex();
+    if (!LittleFS.begin(true)) {
+        LOG_SERROR("LittleFS mount failed, history is not persisted");
+        return false;
+    }
+    if (!LittleFS.exists(HISTORY_LOG_DIR)) {
+        LittleFS.mkdir(HISTORY_LOG_DIR);
+    }
+
+    window_samples = _window_samples;
+    header = { HISTORY_LOG_MAGIC, HISTORY_LOG_VERSION, dc.price_update, configHash(), (uint16_t)num_assets };
+    record_size = sizeof(uint32_t) + num_assets * sizeof(Price);
+    uint32_t per_segment = (HISTORY_LOG_SEGMENT - sizeof(LogHeader)) / record_size;
+    max_segments = min((window_samples + per_segment - 1) / per_segment + 1, (uint32_t)HISTORY_LOG_MAX_SEGMENTS);
+
+    // segment files are numbered, the oldest one has the lowest number
+    File dir = LittleFS.open(HISTORY_LOG_DIR);
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+        const char *name = strrchr(file.name(), '/');
+        uint32_t number = strtoul((name != nullptr) ? name + 1 : file.name(), nullptr, 10);
+        if (number > 0) {
+            first_segment = (first_segment == 0) ? number : min(first_segment, number);
+            if (number > last_segment) {
+                last_segment = number;
+                segment_size = file.size();
+            }
+        }
+        file.close();
+    }
+    dir.close();
+
+    if (last_segment != 0) {
+        char path[32];
+        segmentPath(last_segment, path, sizeof(path));
+        File file = LittleFS.open(path, "r");
+        bool valid = file && readHeader(file);
+        file.close();
+        if (!valid) {
+            LOG_SINFO("History log of another configuration, discarded");
+            removeSegments();
+        }
+    }
+
+    LOG_SINFO("History log: %u segments, max. %u (%u bytes used)", (last_segment != 0) ? last_segment - first_segment + 1 : 0,
+              max_segments, LittleFS.usedBytes());
+    log_ready = true;
+    return true;
+}
+
+/**
+ * Feeds all logged samples of the window to a handler, oldest first, in one pass over the segments
+ * While the device was off no samples were taken, these gaps are filled with the last logged prices
+ * if the clock is set.
+ *
+ * @param handler     Called for every sample
+ * @param fill_to_now Fill the gap from the last record up to now (false if it is backfilled)
+ * @return replayed samples
+ */
+uint32_t replayHistoryLog(HistorySampleHandler handler, bool fill_to_now) {
+    if (!log_ready || last_segment == 0) {
+        return 0;
+    }
+
+    uint32_t now = time(nullptr);
+    bool clock_valid = now > HISTORY_CLOCK_VALID;
+    uint32_t interval = dc.price_update * 60UL;
+    uint32_t window = window_samples * interval;
+
+    uint8_t chunk[8 * sizeof(HistoryRecord)];
+    HistoryRecord record = {};
+    HistoryRecord last = {};
+    uint32_t count = 0;
+    char path[32];
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    for (uint32_t number = first_segment; number <= last_segment; number++) {
+        segmentPath(number, path, sizeof(path));
+        File file = LittleFS.open(path, "r");
+        if (!file || !readHeader(file)) {
+            file.close();
+            continue;
+        }
+
+        size_t len;
+        while ((len = file.read(chunk, 8 * record_size)) >= record_size) {
+            // a torn record at the end of the segment is ignored
+            for (size_t i = 0; i < len / record_size; i++) {
+                readRecord(chunk + i * record_size, record);
+                if (clock_valid && record.time != 0 && record.time + window < now) {
+                    continue;
+                }
+                if (count > 0 && last.time != 0 && record.time > last.time) {
+                    uint32_t missing = (record.time - last.time + interval / 2) / interval;
+                    for (uint32_t m = 1; m < missing && m <= window_samples; m++, count++) {
+                        handler(last.prices);
+                    }
+                }
+                handler(record.prices);
+                last = record;
+                count++;
+            }
+        }
+        file.close();
+    }
+    xSemaphoreGive(log_mutex);
+
+    // up to the next live sample
+    if (fill_to_now && count > 0 && clock_valid && last.time != 0 && now > last.time) {
+        uint32_t missing = (now - last.time + interval / 2) / interval;
+        for (uint32_t m = 1; m < missing && m <= window_samples; m++, count++) {
+            handler(last.prices);
+        }
+    }
+    return count;
+}
+
+/**
+ * Time of the first and the last logged record
+ *
+ * @return false if the log is empty
+ */
+bool getHistoryLogRange(uint32_t &first_time, uint32_t &last_time) {
+    first_time = 0;
+    last_time = 0;
+    if (!log_ready || last_segment == 0) {
+        return false;
+    }
+
+    HistoryRecord record = {};
+    char path[32];
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    for (uint32_t number = first_segment; number <= last_segment && first_time == 0; number++) {
+        segmentPath(number, path, sizeof(path));
+        File file = LittleFS.open(path, "r");
+        if (file && readHeader(file) && file.read((uint8_t *)&record, record_size) == record_size) {
+            first_time = record.time;
+        }
+        file.close();
+    }
+
+    segmentPath(last_segment, path, sizeof(path));
+    File file = LittleFS.open(path, "r");
+    size_t records = file ? (file.size() - sizeof(LogHeader)) / record_size : 0;
+    if (records > 0 && file.seek(sizeof(LogHeader) + (records - 1) * record_size)
+        && file.read((uint8_t *)&record, record_size) == record_size) {
+        last_time = record.time;
+    }
+    file.close();
+    xSemaphoreGive(log_mutex);
+    return true;
+}
+
+/**
+ * Buffers a history sample, every HISTORY_LOG_BATCH samples are written to flash at once (fetch task)
+ * Samples have to be appended in time order, the replay bridges the gaps between them.
+ *
+ * @param prices      Price per asset
+ * @param sample_time Unix time of the sample
+ */
+void appendHistoryLog(const Price *prices, uint32_t sample_time) {
+    if (!log_ready) {
+        return;
+    }
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    uint8_t *record = batch + batch_count++ * record_size;
+    uint32_t record_time = (sample_time > HISTORY_CLOCK_VALID) ? sample_time : 0;
+    memcpy(record, &record_time, sizeof(record_time));
+    memcpy(record + sizeof(record_time), prices, num_assets * sizeof(Price));
+    if (batch_count >= HISTORY_LOG_BATCH) {
+        writeBatch();
+    }
+    xSemaphoreGive(log_mutex);
+}
+
+/**
+ * Writes the buffered samples, e.g. before a restart
+ */
+void flushHistoryLog() {
+    if (!log_ready) {
+        return;
+    }
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    writeBatch();
+    xSemaphoreGive(log_mutex);
+}
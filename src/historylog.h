@@ -0,0 +1,29 @@
+#ifndef HISTORYLOG_H
+#define HISTORYLOG_H
+
+#include <Arduino.h>
+#include "display.h"
+#include "price.h"
+
+#define HISTORY_LOG_DIR          "/history"
+#define HISTORY_LOG_BATCH        16         // samples buffered per flash write
+#define HISTORY_LOG_SEGMENT      16384      // max. bytes per segment file
+#define HISTORY_LOG_MAX_SEGMENTS 64
+#define HISTORY_RESTORE_WAIT     20000      // ms after boot to wait for the clock before replaying
+#define HISTORY_CLOCK_VALID      1600000000 // unix times below are an unset clock
+
+// One history sample of all assets, stored packed with the configured number of assets
+struct HistoryRecord {
+    uint32_t time;                  // unix time, 0 = clock not set
+    Price prices[MAX_ASSETS];
+};
+
+typedef void (*HistorySampleHandler)(const Price *prices);
+
+bool initHistoryLog(uint32_t window_samples);
+uint32_t replayHistoryLog(HistorySampleHandler handler, bool fill_to_now);
+bool getHistoryLogRange(uint32_t &first_time, uint32_t &last_time);
+void appendHistoryLog(const Price *prices, uint32_t sample_time);
+void flushHistoryLog();
+
+#endif // HISTORYLOG_H
@@ -0,0 +1,253 @@
+#include "globals.h"
+#include "metrics.h"
+#include "scheduler.h"
+#include "dnscache.h"
+#include <new>
+
+static const char *phase_names[PHASE_COUNT] = { "dns", "connect", "ttfb", "body", "parse", "total" };
+
+static const char *frame_names[FRAME_KINDS] = { "asset", "clock", "transition" };
+
+// allocated at boot for the configured symbols, see beginFetchMetrics()
+static FetchMetrics *metrics = nullptr;
+static int num_keys = 0;
+static FrameMetrics frame_metrics[FRAME_KINDS];
+static SemaphoreHandle_t metrics_mutex = nullptr;
+
+// ====================================================================================================
+// LatencyHistogram ===================================================================================
+// ====================================================================================================
+static int bucketIndex(uint32_t us) {
+    if (us < (1UL << METRICS_MIN_SHIFT)) {
+        return 0;
+    }
+    int msb = 31 - __builtin_clz(us);
+    int sub = (us >> (msb - 2)) & (METRICS_SUB_BUCKETS - 1);
+    int index = 1 + (msb - METRICS_MIN_SHIFT) * METRICS_SUB_BUCKETS + sub;
+    return (index < METRICS_BUCKETS) ? index : METRICS_BUCKETS - 1;
+}
+
+// upper bound of a bucket in microseconds
+static uint32_t bucketLimit(int index) {
+    if (index == 0) {
+        return 1UL << METRICS_MIN_SHIFT;
+    }
+    int msb = METRICS_MIN_SHIFT + (index - 1) / METRICS_SUB_BUCKETS;
+    int sub = (index - 1) % METRICS_SUB_BUCKETS;
+    return (uint32_t)(METRICS_SUB_BUCKETS + sub + 1) << (msb - 2);
+}
+
+void LatencyHistogram::add(uint32_t us) {
+    uint16_t &bucket = buckets[bucketIndex(us)];
+    if (bucket < UINT16_MAX) {
+        bucket++;
+    }
+    count++;
+    if (us > max) {
+        max = us;
+    }
+}
+
+/**
+ * @param p Percentile 0-100
+ * @return upper bound of the bucket holding the percentile, never more than the max. value
+ */
+uint32_t LatencyHistogram::percentile(uint8_t p) const {
+    uint32_t total = 0;
+    for (int i = 0; i < METRICS_BUCKETS; i++) {
+        total += buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint32_t rank = (total * p + 99) / 100;
+    uint32_t sum = 0;
+    for (int i = 0; i < METRICS_BUCKETS; i++) {
+        sum += buckets[i];
+        if (sum >= rank) {
+            uint32_t limit = bucketLimit(i);
+            return (limit < max) ? limit : max;
+        }
+    }
+    return max;
+}
+
+// ====================================================================================================
+// Fetch metrics ======================================================================================
+// ====================================================================================================
+static FetchMetrics *findMetrics(const char *key) {
+    for (int i = 0; i < num_keys; i++) {
+        if (metrics[i].key[0] == '\0') {
+            snprintf(metrics[i].key, sizeof(metrics[i].key), "%s", key);
+            return &metrics[i];
+        }
+        if (strcmp(metrics[i].key, key) == 0) {
+            return &metrics[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Adds the phase timing of a request to the histograms of a symbol
+ *
+ * @param key    Symbol name or request name for batch requests
+ * @param timing Timing of the request
+ */
+void recordFetch(const char *key, const HttpTiming &timing) {
+    xSemaphoreTake(metrics_mutex, portMAX_DELAY);
+
+    FetchMetrics *m = findMetrics(key);
+    if (m != nullptr && timing.code == HTTP_BREAKER_OPEN) {
+        m->rejected++;
+    } else if (m != nullptr) {
+        m->requests++;
+        if (timing.code <= 0 || timing.code >= 400) {
+            m->errors++;
+        }
+        if (timing.reused) {
+            m->reused++;
+        } else {
+            // connection phases only exist for new connections
+            m->phases[PHASE_DNS].add(timing.dns_us);
+            m->phases[PHASE_CONNECT].add(timing.connect_us);
+        }
+        if (timing.code > 0) {
+            m->phases[PHASE_TTFB].add(timing.ttfb_us);
+            m->phases[PHASE_BODY].add(timing.body_us);
+            m->phases[PHASE_PARSE].add(timing.parse_us);
+        }
+        m->phases[PHASE_TOTAL].add(timing.total_us);
+    }
+
+    xSemaphoreGive(metrics_mutex);
+}
+
+/**
+ * Records the times of a display frame (render task)
+ */
+void recordFrame(FrameKind kind, uint32_t render_us, uint32_t flush_us, uint32_t pixels, uint32_t lag_us) {
+    xSemaphoreTake(metrics_mutex, portMAX_DELAY);
+    frame_metrics[kind].render.add(render_us);
+    frame_metrics[kind].flush.add(flush_us);
+    frame_metrics[kind].lag.add(lag_us);
+    frame_metrics[kind].pixels += pixels;
+    xSemaphoreGive(metrics_mutex);
+}
+
+/**
+ * Prints p50/p95/max of all phases in milliseconds
+ */
+void printMetrics() {
+    RateLimitStatus rate = getRateLimitStatus(TIMENOW);
+    LOG_SINFO("Rate limit: %u/%u weight used, %u remaining, blocked %u s, %.1f request tokens",
+              rate.used_weight, rate.limit, rate.remaining, rate.blocked_ms / 1000, rate.tokens);
+
+    const DnsCacheStats &dns = getDnsCacheStats();
+    LOG_SINFO("DNS cache: %u hits, %u stale hits, %u misses, %u refreshes, %u failures",
+              dns.hits, dns.stale_hits, dns.misses, dns.refreshes, dns.failures);
+
+    xSemaphoreTake(metrics_mutex, portMAX_DELAY);
+    for (int i = 0; i < num_keys && metrics[i].key[0] != '\0'; i++) {
+        const FetchMetrics &m = metrics[i];
+        LOG_SINFO("%s: %u requests, %u reused, %u errors, %u rejected", m.key, m.requests, m.reused, m.errors, m.rejected);
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            const LatencyHistogram &h = m.phases[p];
+            if (h.count > 0) {
+                LOG_SINFO("  %-8s p50: %7.1f p95: %7.1f max: %7.1f ms", phase_names[p],
+                          h.percentile(50) / 1000.0f, h.percentile(95) / 1000.0f, h.max / 1000.0f);
+            }
+        }
+    }
+    for (int k = 0; k < FRAME_KINDS; k++) {
+        const FrameMetrics &f = frame_metrics[k];
+        if (f.render.count > 0) {
+            LOG_SINFO("%s frames (%s): %u, render p50: %.1f max: %.1f ms, flush p50: %.1f max: %.1f ms, "
+                      "lag p95: %.1f ms, %u pixels/frame",
+                      frame_names[k], isFramebufferActive() ? "framebuffer" : "direct", f.render.count,
+                      f.render.percentile(50) / 1000.0f, f.render.max / 1000.0f,
+                      f.flush.percentile(50) / 1000.0f, f.flush.max / 1000.0f,
+                      f.lag.percentile(95) / 1000.0f, (unsigned)(f.pixels / f.render.count));
+        }
+    }
+    xSemaphoreGive(metrics_mutex);
+}
+
+/**
+ * Writes all metrics as JSON, times in microseconds
+ * {"uptime":..,"pool":{..},"rate":{..},"dns_cache":{..},"fetch":[{"key":"BTCUSDT","requests":..,"dns":{"count":..,"p50":..,"p95":..,"max":..},..}],
+ *  "display":{"framebuffer":..,"asset":{"render":{..},"flush":{..},"lag":{..},"pixels":..},"clock":{..},"transition":{..}}}
+ */
+void writeMetricsJson(Print &out) {
+    const HttpPoolStats &pool = getHttpPoolStats();
+    RateLimitStatus rate = getRateLimitStatus(TIMENOW);
+    out.printf("{\"uptime\":%lu,\"heap\":%u,\"pool\":{\"requests\":%u,\"reused\":%u,\"connects\":%u,\"idle_closed\":%u},",
+               TIMENOW / 1000, ESP.getFreeHeap(), pool.requests, pool.reused, pool.connects, pool.idle_closed);
+    out.printf("\"rate\":{\"used_weight\":%u,\"limit\":%u,\"remaining\":%u,\"blocked_ms\":%u,\"tokens\":%.1f},",
+               rate.used_weight, rate.limit, rate.remaining, rate.blocked_ms, rate.tokens);
+    const DnsCacheStats &dns = getDnsCacheStats();
+    out.printf("\"dns_cache\":{\"hits\":%u,\"stale_hits\":%u,\"misses\":%u,\"refreshes\":%u,\"failures\":%u},\"fetch\":[",
+               dns.hits, dns.stale_hits, dns.misses, dns.refreshes, dns.failures);
+
+    xSemaphoreTake(metrics_mutex, portMAX_DELAY);
+    for (int i = 0; i < num_keys && metrics[i].key[0] != '\0'; i++) {
+        const FetchMetrics &m = metrics[i];
+        out.printf("%s{\"key\":\"%s\",\"requests\":%u,\"reused\":%u,\"errors\":%u,\"rejected\":%u", (i > 0) ? "," : "",
+                   m.key, m.requests, m.reused, m.errors, m.rejected);
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            const LatencyHistogram &h = m.phases[p];
+            out.printf(",\"%s\":{\"count\":%u,\"p50\":%u,\"p95\":%u,\"max\":%u}", phase_names[p],
+                       h.count, h.percentile(50), h.percentile(95), h.max);
+        }
+        out.print("}");
+    }
+
+    out.printf("],\"display\":{\"framebuffer\":%s", isFramebufferActive() ? "true" : "false");
+    for (int k = 0; k < FRAME_KINDS; k++) {
+        const FrameMetrics &f = frame_metrics[k];
+        out.printf(",\"%s\":{\"render\":{\"count\":%u,\"p50\":%u,\"p95\":%u,\"max\":%u},"
+                   "\"flush\":{\"count\":%u,\"p50\":%u,\"p95\":%u,\"max\":%u},"
+                   "\"lag\":{\"count\":%u,\"p50\":%u,\"p95\":%u,\"max\":%u},\"pixels\":%llu}", frame_names[k],
+                   f.render.count, f.render.percentile(50), f.render.percentile(95), f.render.max,
+                   f.flush.count, f.flush.percentile(50), f.flush.percentile(95), f.flush.max,
+                   f.lag.count, f.lag.percentile(50), f.lag.percentile(95), f.lag.max,
+                   (unsigned long long)f.pixels);
+    }
+    xSemaphoreGive(metrics_mutex);
+
+    out.print("}}");
+}
+
+/**
+ * Allocates the histograms of the fetch metrics, call before the first request
+ *
+ * @param keys One per fetched symbol + the batch request
+ * @return false if the allocation failed, requests are not recorded then
+ */
+bool beginFetchMetrics(int keys) {
+    FetchMetrics *allocated = new (std::nothrow) FetchMetrics[keys]();
+    if (allocated == nullptr) {
+        LOG_SERROR("Fetch metrics allocation failed");
+        return false;
+    }
+    xSemaphoreTake(metrics_mutex, portMAX_DELAY);
+    delete[] metrics;
+    metrics = allocated;
+    num_keys = keys;
+    xSemaphoreGive(metrics_mutex);
+    LOG_SINFO("Fetch metrics: %d keys, %d bytes", keys, keys * sizeof(FetchMetrics));
+    return true;
+}
+
+/**
+ * Registers the /metrics route of the web interface
+ */
+void initMetrics() {
+    metrics_mutex = xSemaphoreCreateMutex();
+    wp.on("/metrics", [](AsyncWebServerRequest *request) {
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        writeMetricsJson(*response);
+        request->send(response);
+    });
+}
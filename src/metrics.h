@@ -0,0 +1,59 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include "display.h"
+#include "network.h"
+
+#define METRICS_KEY_LENGTH    17
+#define METRICS_MIN_SHIFT     6                  // first bucket holds everything below 64us
+#define METRICS_SUB_BUCKETS   4                  // buckets per power of two
+#define METRICS_BUCKETS       (1 + 20 * METRICS_SUB_BUCKETS)   // up to ~67s
+#define METRICS_LOG_INTERVAL  10                 // serial dump every n fetch cycles
+
+enum MetricsPhase {
+    PHASE_DNS = 0,
+    PHASE_CONNECT,
+    PHASE_TTFB,
+    PHASE_BODY,
+    PHASE_PARSE,
+    PHASE_TOTAL,
+    PHASE_COUNT
+};
+
+// Log-linear latency histogram in microseconds
+struct LatencyHistogram {
+    uint16_t buckets[METRICS_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+
+    void add(uint32_t us);
+    uint32_t percentile(uint8_t p) const;
+};
+
+// Latency histograms of one symbol (or the batch request)
+struct FetchMetrics {
+    char key[METRICS_KEY_LENGTH];
+    uint32_t requests;
+    uint32_t reused;
+    uint32_t errors;
+    uint32_t rejected;       // failed fast by an open circuit breaker
+    LatencyHistogram phases[PHASE_COUNT];
+};
+
+// Render (compose or direct drawing) and flush times of one kind of frame
+struct FrameMetrics {
+    LatencyHistogram render;
+    LatencyHistogram flush;
+    LatencyHistogram lag;    // start behind the due time (clock: behind the second boundary)
+    uint64_t pixels;         // pixels sent to the panel
+};
+
+void initMetrics();
+bool beginFetchMetrics(int keys);
+void recordFetch(const char *key, const HttpTiming &timing);
+void recordFrame(FrameKind kind, uint32_t render_us, uint32_t flush_us, uint32_t pixels, uint32_t lag_us);
+void printMetrics();
+void writeMetricsJson(Print &out);
+
+#endif // METRICS_H
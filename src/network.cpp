@@ -1,10 +1,400 @@
 #include "globals.h"
 #include "network.h"
+#include "breaker.h"
+#include "dnscache.h"
+#include <atomic>
 
-HttpResult result;
+// Persistent connection to one host, kept open across requests
+struct HttpConnection {
+    char host[HTTP_HOST_LENGTH];
+    uint16_t port;
+    WiFiClientSecure client;
+    HTTPClient http;
+    ulong last_used;
+    CircuitBreaker breaker;     // fails fast while the host is unreachable
+#if defined(ESP8266)
+    BearSSL::Session session;   // TLS session resumption on reconnect
+#endif
+};
+
+static HttpConnection pool[HTTP_POOL_SIZE];
+static HttpPoolStats pool_stats;
+static HttpTiming last_timing;
+static HttpRateInfo last_rate;
+
+// The pool belongs to the fetch task, other tasks only request closing it
+static std::atomic<bool> close_requested{false};
+
+/**
+ * Extracts host name and port of an URL ("https://host:port/path" -> "host", port)
+ */
+static void getUrlHost(const String &url, char *host, size_t size, uint16_t &port) {
+    int start = url.indexOf("://");
+    port = url.startsWith("http://") ? 80 : 443;
+    start = (start < 0) ? 0 : start + 3;
+    int end = start;
+    while (end < (int)url.length() && url[end] != '/' && url[end] != ':' && url[end] != '?') {
+        end++;
+    }
+    snprintf(host, size, "%.*s", end - start, url.c_str() + start);
+    if (end < (int)url.length() && url[end] == ':') {
+        port = atoi(url.c_str() + end + 1);
+    }
+}
+
+/**
+ * Returns the pooled connection for the host of the URL
+ * An idle connection is reused if it is still open, otherwise the least recently used slot is taken over.
+ */
+static HttpConnection &acquireConnection(const String &url) {
+    handleHttpConnections();
+
+    char host[HTTP_HOST_LENGTH];
+    uint16_t port;
+    getUrlHost(url, host, sizeof(host), port);
+
+    HttpConnection *conn = nullptr;
+    for (int i = 0; i < HTTP_POOL_SIZE; i++) {
+        if (strcmp(pool[i].host, host) == 0) {
+            conn = &pool[i];
+            break;
+        }
+        if (conn == nullptr || pool[i].last_used < conn->last_used) {
+            conn = &pool[i];
+        }
+    }
+
+    if (strcmp(conn->host, host) != 0 || conn->port != port) {
+        // take over least recently used slot
+        if (conn->client.connected()) {
+            conn->client.stop();
+        }
+        snprintf(conn->host, sizeof(conn->host), "%s", host);
+        conn->port = port;
+        conn->breaker.reset();
+        conn->client.setInsecure();
+#if defined(ESP8266)
+        conn->session = BearSSL::Session();
+        conn->client.setSession(&conn->session);
+#endif
+    } else if (conn->client.connected() && (ulong)(TIMENOW - conn->last_used) >= HTTP_KEEPALIVE_IDLE) {
+        // the server has most likely dropped the connection already, don't risk a failing write
+        conn->client.stop();
+        pool_stats.idle_closed++;
+    }
+    return *conn;
+}
+
+/**
+ * Opens the TLS connection of a pool slot if it is not open anymore
+ * DNS lookup and connect are done here instead of HTTPClient, so both phases can be timed.
+ */
+static bool openConnection(HttpConnection &conn, const uint16_t time_out, HttpTiming &timing) {
+    pool_stats.requests++;
+    conn.last_used = TIMENOW;
+
+    if (conn.client.connected()) {
+        pool_stats.reused++;
+        timing.reused = true;
+        return true;
+    }
+    pool_stats.connects++;
+
+    ulong start = micros();
+#if defined(ESP8266)
+    // BearSSL resolves the host itself
+    bool connected = conn.client.connect(conn.host, conn.port);
+#else
+    IPAddress ip;
+    if (!resolveHost(conn.host, ip)) {
+        timing.dns_us = micros() - start;
+        LOG_SERROR("DNS lookup failed for %s", conn.host);
+        return false;
+    }
+    timing.dns_us = micros() - start;
+
+    start = micros();
+    conn.client.setHandshakeTimeout((time_out + 999) / 1000);
+    bool connected = conn.client.connect(ip, conn.port, conn.host, nullptr, nullptr, nullptr);
+#endif
+    timing.connect_us = micros() - start;
+
+    if (!connected) {
+        LOG_SERROR("Connection to %s:%u failed", conn.host, conn.port);
+#if !defined(ESP8266)
+        // the address may have moved
+        invalidateHost(conn.host);
+#endif
+    }
+    return connected;
+}
+
+// ====================================================================================================
+// HttpBodyStream =====================================================================================
+// ====================================================================================================
+HttpBodyStream::HttpBodyStream(Stream &_client, bool _chunked, int content_length)
+    : client(_client), chunked(_chunked) {
+    remaining = chunked ? 0 : content_length;
+    done = (!chunked && content_length == 0);
+}
+
+int HttpBodyStream::clientRead() {
+    if (client.available() > 0) {
+        return client.read();
+    }
+    char c;
+    ulong start = micros();
+    size_t r = client.readBytes(&c, 1);
+    wait_us += micros() - start;
+    return (r == 1) ? (uint8_t)c : -1;
+}
+
+/**
+ * Reads the next chunk header "<hex size>[;ext]\r\n", the last chunk (size 0) ends the body
+ */
+bool HttpBodyStream::nextChunk() {
+    if (!chunked) {
+        done = true;
+        return false;
+    }
+    // CRLF after the previous chunk data
+    if (!first_chunk && (clientRead() != '\r' || clientRead() != '\n')) {
+        error = done = true;
+        return false;
+    }
+    first_chunk = false;
+
+    int32_t size = 0;
+    int digits = 0;
+    int c;
+    while ((c = clientRead()) >= 0 && isxdigit(c)) {
+        size = (size << 4) | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+        digits++;
+    }
+    // skip chunk extensions up to the line end
+    while (c >= 0 && c != '\n') {
+        c = clientRead();
+    }
+    if (c < 0 || digits == 0) {
+        error = done = true;
+        return false;
+    }
+
+    if (size == 0) {
+        // skip trailer lines up to the empty line
+        int line_length = 0;
+        while ((c = clientRead()) >= 0) {
+            if (c == '\n') {
+                if (line_length == 0) break;
+                line_length = 0;
+            } else if (c != '\r') {
+                line_length++;
+            }
+        }
+        error = (c < 0);
+        done = true;
+        return false;
+    }
+    remaining = size;
+    return true;
+}
+
+int HttpBodyStream::available() {
+    if (done) {
+        return 0;
+    }
+    int count = client.available();
+    if (remaining > 0 && count > remaining) {
+        count = remaining;
+    }
+    return count;
+}
+
+int HttpBodyStream::read() {
+    if (done || (remaining == 0 && !nextChunk())) {
+        return -1;
+    }
+    int c = client.read();
+    if (c >= 0 && remaining > 0) {
+        remaining--;
+        done = (!chunked && remaining == 0);
+    }
+    return c;
+}
+
+int HttpBodyStream::peek() {
+    if (done || (remaining == 0 && !nextChunk())) {
+        return -1;
+    }
+    return client.peek();
+}
+
+size_t HttpBodyStream::readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length && !done) {
+        if (remaining == 0 && !nextChunk()) {
+            break;
+        }
+        size_t n = length - count;
+        if (remaining > 0 && n > (size_t)remaining) {
+            n = remaining;
+        }
+        size_t r;
+        if (client.available() >= (int)n) {
+            r = client.readBytes(buffer + count, n);
+        } else {
+            // only time reads that have to wait for the network
+            ulong start = micros();
+            r = client.readBytes(buffer + count, n);
+            wait_us += micros() - start;
+        }
+        if (r == 0) {
+            // timeout, or connection closed for a body without length
+            done = true;
+            error = (remaining > 0);
+            break;
+        }
+        count += r;
+        if (remaining > 0) {
+            remaining -= r;
+            done = (!chunked && remaining == 0);
+        }
+    }
+    return count;
+}
+
+/**
+ * Discards the unread rest of the body
+ *
+ * @param limit Max. number of bytes to discard
+ * @return number of discarded bytes
+ */
+size_t HttpBodyStream::drain(size_t limit) {
+    char buffer[64];
+    size_t count = 0;
+    while (!done && count < limit) {
+        size_t r = readBytes(buffer, sizeof(buffer));
+        if (r == 0) break;
+        count += r;
+    }
+    return count;
+}
+
+// ====================================================================================================
+// HTTP requests ======================================================================================
+// ====================================================================================================
+
+/**
+ * Performs an HTTP GET request and passes the response body as stream to a handler
+ * The body is read straight from the socket and never buffered, so the response size is not limited.
+ * The TLS connection to the host is kept open for the next request.
+ *
+ * @param url      The URL to fetch
+ * @param handler  Called with the body stream if the request was successful
+ * @param code     Output HTTP status code (-1 if the connection failed)
+ * @param time_out Request timeout in milliseconds - default 3000
+ * @return true if the request was successful (HTTP status 1xx-3xx) and the handler returned true
+ */
+bool httpGetStream(const String &url, const HttpStreamHandler &handler, int &code, const uint16_t time_out) {
+    static const char *header_keys[] = { "Transfer-Encoding", "X-MBX-USED-WEIGHT-1M", "Retry-After" };
+
+    code = -1;
+    bool success = false;
+
+    HttpTiming &timing = last_timing;
+    timing = HttpTiming();
+    timing.code = -1;
+    last_rate.used_weight = -1;
+    last_rate.retry_after = 0;
+    ulong request_start = micros();
+
+    HttpConnection &conn = acquireConnection(url);
+    if (!conn.breaker.allow(TIMENOW)) {
+        code = timing.code = HTTP_BREAKER_OPEN;
+        return false;
+    }
+    if (!openConnection(conn, time_out, timing)) {
+        conn.breaker.failure(TIMENOW, conn.host);
+        timing.total_us = micros() - request_start;
+        return false;
+    }
+
+    HTTPClient &http = conn.http;
+    http.setReuse(true);
+    http.setTimeout(time_out);
+    http.collectHeaders(header_keys, sizeof(header_keys) / sizeof(header_keys[0]));
+
+    if (http.begin(conn.client, url)) {
+        ulong start = micros();
+        code = http.GET();
+        timing.ttfb_us = micros() - start;
+
+        if (code > 0) {
+            if (http.hasHeader("X-MBX-USED-WEIGHT-1M")) {
+                last_rate.used_weight = http.header("X-MBX-USED-WEIGHT-1M").toInt();
+            }
+            last_rate.retry_after = http.header("Retry-After").toInt();
+        }
+
+        if (code > 0) {
+            HttpBodyStream body(conn.client, http.header("Transfer-Encoding").equalsIgnoreCase("chunked"), http.getSize());
+            body.setTimeout(time_out);
+
+            if (code < 400) {
+                start = micros();
+                success = handler(body);
+                uint32_t handler_us = micros() - start;
+                timing.body_us = body.getWaitTime();
+                timing.parse_us = handler_us - timing.body_us;
+            }
+
+            // drop the unread rest, a large rest is cheaper to skip by reconnecting
+            body.drain(HTTP_DRAIN_LIMIT);
+            if (!body.finished()) {
+                conn.client.stop();
+            }
+        }
+        // keeps the connection open if the server allows it
+        http.end();
+    }
+    // connection errors, timeouts and server errors count against the host
+    if (code <= 0 || code >= 500) {
+        conn.breaker.failure(TIMENOW, conn.host);
+    } else {
+        conn.breaker.success();
+    }
+
+    timing.code = code;
+    timing.total_us = micros() - request_start;
+    return success;
+}
+
+/**
+ * Performs an HTTP GET request and passes the response body in chunks of up to HTTP_CHUNK_BUFFER bytes
+ *
+ * @param url      The URL to fetch
+ * @param handler  Called for each body chunk, returns false to stop reading
+ * @param code     Output HTTP status code (-1 if the connection failed)
+ * @param time_out Request timeout in milliseconds - default 3000
+ * @return true if the request was successful and the handler consumed the whole body
+ */
+bool httpGetChunked(const String &url, const HttpChunkHandler &handler, int &code, const uint16_t time_out) {
+    return httpGetStream(url, [&](Stream &stream) -> bool {
+        uint8_t buffer[HTTP_CHUNK_BUFFER];
+        size_t length;
+        while ((length = stream.readBytes(buffer, sizeof(buffer))) > 0) {
+            if (!handler(buffer, length)) {
+                return false;
+            }
+        }
+        return true;
+    }, code, time_out);
+}
 
 /**
  * Performs an HTTP GET request to the specified URL
+ * For small responses only, larger bodies are truncated to HTTP_PAYLOAD_BUFFER - 1 bytes.
+ * Use httpGetStream() or httpGetChunked() to consume bodies of any size.
  *
  * @param url      The URL to fetch
  * @param result   Output struct containing HTTP status code, bytes read and payload
@@ -12,30 +402,60 @@ HttpResult result;
  * @return true if the request was successful (HTTP status 1xx-3xx), false on error or HTTP 4xx/5xx
  */
 bool httpGet(const String &url, HttpResult &result, const uint16_t time_out) {
-    result.code = -1;
     result.bytes_read = 0;
+    result.truncated = false;
     result.payload[0] = '\0';
 
-    WiFiClientSecure client;
-    client.setInsecure();
-    HTTPClient http;
-    http.setTimeout(time_out);
+    httpGetChunked(url, [&](const uint8_t *data, size_t length) -> bool {
+        size_t space = sizeof(result.payload) - 1 - result.bytes_read;
+        if (length > space) {
+            length = space;
+            result.truncated = true;
+        }
+        memcpy(result.payload + result.bytes_read, data, length);
+        result.bytes_read += length;
+        result.payload[result.bytes_read] = '\0';
+        return !result.truncated;
+    }, result.code, time_out);
+
+    if (result.truncated) {
+        LOG_SERROR("HTTP payload truncated to %u bytes", result.bytes_read);
+    }
+    return (result.code > 0 && result.code < 400);
+}
 
-    if (http.begin(client, url)) {
-        result.code = http.GET();
+const HttpPoolStats &getHttpPoolStats() {
+    return pool_stats;
+}
 
-        if (result.code > 0) {
-            String payload = http.getString();
-            result.bytes_read = payload.length();
-            if (result.bytes_read >= sizeof(result.payload)) {
-                result.bytes_read = sizeof(result.payload) - 1;
-            }
-            memcpy(result.payload, payload.c_str(), result.bytes_read);
-            result.payload[result.bytes_read] = '\0';
+const HttpTiming &getLastHttpTiming() {
+    return last_timing;
+}
+
+const HttpRateInfo &getLastRateInfo() {
+    return last_rate;
+}
+
+/**
+ * Requests closing all pooled connections (e.g. on WiFi loss), safe to call from any task
+ * The connections are closed by the fetch task in handleHttpConnections().
+ */
+void closeHttpConnections() {
+    close_requested = true;
+}
+
+/**
+ * Closes all pooled connections if requested, call from the fetch task loop
+ */
+void handleHttpConnections() {
+    if (!close_requested.exchange(false)) {
+        return;
+    }
+    for (int i = 0; i < HTTP_POOL_SIZE; i++) {
+        if (pool[i].client.connected()) {
+            pool[i].client.stop();
         }
-        http.end();
     }
-    return (result.code > 0 && result.code < 400);
 }
 
 /**
@@ -66,6 +486,7 @@ void handleWiFi() {
         // check for AP fallback condition
     } else if (sw.getMode() == WIFI_STA && dc.ap_fallback > 0 && sw.getAttempts() >= dc.ap_fallback) {
         LOG_SDEBUG("AP Fallback activated");
+        closeHttpConnections();
         wp.stop();
         sw.setMode(WIFI_AP);
     }
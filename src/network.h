@@ -1,19 +1,93 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
+#include <functional>
+
 #define HTTP_PAYLOAD_BUFFER    512
+#define HTTP_POOL_SIZE         2        // max. number of hosts with an open TLS connection (~40KB heap each)
+#define HTTP_KEEPALIVE_IDLE    30000    // idle time in ms after which a pooled connection is closed
+#define HTTP_HOST_LENGTH       64
+#define HTTP_CHUNK_BUFFER      256      // read buffer of httpGetChunked()
+#define HTTP_BREAKER_OPEN      -20      // request not sent, host circuit breaker is open
+#define HTTP_DRAIN_LIMIT       16384    // unread body bytes discarded to keep the connection, larger rest closes it
 
 struct HttpResult {
     int code;
     size_t bytes_read;
+    bool truncated;          // body was larger than the payload buffer
     char payload[HTTP_PAYLOAD_BUFFER];
 };
 
+// Phase timing of the last request in microseconds
+struct HttpTiming {
+    uint32_t dns_us;         // host name lookup (new connections only)
+    uint32_t connect_us;     // TCP connect + TLS handshake (new connections only)
+    uint32_t ttfb_us;        // request sent until status line and headers received
+    uint32_t body_us;        // waiting for body data from the socket
+    uint32_t parse_us;       // body handler time without socket waits (JSON parsing)
+    uint32_t total_us;
+    bool reused;             // request was sent on an open connection
+    int code;
+};
+
+// Rate limit headers of the last response
+struct HttpRateInfo {
+    int32_t used_weight;     // X-MBX-USED-WEIGHT-1M, -1 if not sent
+    uint32_t retry_after;    // Retry-After in seconds, 0 if not sent
+};
+
+/**
+ * Response body read straight from the socket
+ * Decodes chunked transfer encoding on the fly and stops at the end of the body,
+ * so the connection can be reused for the next request.
+ */
+class HttpBodyStream : public Stream {
+  public:
+    HttpBodyStream(Stream &_client, bool _chunked, int content_length);
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t write(uint8_t) override { return 0; }
+    size_t drain(size_t limit);
+    bool finished() const { return done && !error; }
+    uint32_t getWaitTime() const { return wait_us; }
+
+  private:
+    Stream &client;
+    bool chunked;
+    bool first_chunk = true;
+    bool done = false;
+    bool error = false;
+    int32_t remaining;      // bytes left in the body or current chunk, -1 = until connection close
+    uint32_t wait_us = 0;   // time spent blocking on the socket
+    bool nextChunk();
+    int clientRead();
+};
+
+// Connection reuse statistics of the HTTP connection pool
+struct HttpPoolStats {
+    uint32_t requests;       // requests sent through the pool
+    uint32_t reused;         // requests sent on an already open connection
+    uint32_t connects;       // new TCP/TLS connections
+    uint32_t idle_closed;    // connections closed after HTTP_KEEPALIVE_IDLE
+};
+
+// Consumes the response body directly from the socket, returns false on parse error
+typedef std::function<bool(Stream &stream)> HttpStreamHandler;
+// Consumes the response body chunk by chunk, returns false to abort
+typedef std::function<bool(const uint8_t *data, size_t length)> HttpChunkHandler;
+
 bool httpGet(const String &url, HttpResult &result, const uint16_t time_out = 3000);
+bool httpGetStream(const String &url, const HttpStreamHandler &handler, int &code, const uint16_t time_out = 3000);
+bool httpGetChunked(const String &url, const HttpChunkHandler &handler, int &code, const uint16_t time_out = 3000);
+const HttpPoolStats &getHttpPoolStats();
+const HttpTiming &getLastHttpTiming();
+const HttpRateInfo &getLastRateInfo();
+void closeHttpConnections();
+void handleHttpConnections();
 void initWifi();
 void handleWiFi();
 void updateNTP();
 
-extern HttpResult result;
-
 #endif // NETWORK_H
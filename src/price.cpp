@@ -0,0 +1,186 @@
+#include "globals.h"
+#include "price.h"
+
+static const int64_t powers_of_ten[PRICE_DECIMALS + 1] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL
+};
+
+/**
+ * Parses a decimal string as sent by the exchange (e.g. "60123.45000000") without a float conversion
+ * Fraction digits beyond PRICE_DECIMALS are rounded.
+ *
+ * @param text  Decimal string, no sign, no exponent
+ * @param price Parsed price
+ * @return false if the text is not a valid price
+ */
+bool parseDecimalPrice(const char *text, Price &price) {
+    if (text == nullptr) {
+        return false;
+    }
+
+    int64_t integer = 0;
+    int64_t fraction = 0;
+    int int_digits = 0;
+    int frac_digits = 0;
+    bool round_up = false;
+
+    const char *c = text;
+    for (; *c >= '0' && *c <= '9'; c++) {
+        if (++int_digits > PRICE_INT_DIGITS) {
+            return false;
+        }
+        integer = integer * 10 + (*c - '0');
+    }
+    if (*c == '.') {
+        for (c++; *c >= '0' && *c <= '9'; c++) {
+            if (frac_digits < PRICE_DECIMALS) {
+                fraction = fraction * 10 + (*c - '0');
+                frac_digits++;
+            } else if (frac_digits++ == PRICE_DECIMALS) {
+                round_up = (*c >= '5');
+            }
+        }
+    }
+    if (*c != '\0' || int_digits + frac_digits == 0) {
+        return false;
+    }
+
+    frac_digits = min(frac_digits, PRICE_DECIMALS);
+    price = integer * PRICE_SCALE + fraction * powers_of_ten[PRICE_DECIMALS - frac_digits] + (round_up ? 1 : 0);
+    return true;
+}
+
+/**
+ * Fills the market info from the raw payload fields, missing or invalid fields become 0
+ *
+ * @param mark_price      Mark price as decimal string
+ * @param funding_rate    Last funding rate as decimal string, may be negative
+ * @param next_funding_ms Unix time (ms) of the next funding
+ * @param info            Parsed market info
+ * @return false if no valid mark price was found
+ */
+bool parseMarketInfo(const char *mark_price, const char *funding_rate, uint64_t next_funding_ms, MarketInfo &info) {
+    if (!parseDecimalPrice(mark_price, info.mark_price)) {
+        info.mark_price = 0;
+    }
+    info.funding_rate = (funding_rate != nullptr) ? strtof(funding_rate, nullptr) : 0.0f;
+    info.next_funding = (uint32_t)(next_funding_ms / 1000);
+    return info.mark_price > 0;
+}
+
+/**
+ * Formats a price with a fixed number of decimals, written back to front (no printf, no float)
+ * Only the rounding and the split into integer and fraction need 64-bit divisions, the digits are
+ * produced with 32-bit arithmetic.
+ *
+ * @param buffer    Output buffer, always terminated
+ * @param size      Size of the buffer
+ * @param price     Price to format
+ * @param digits    Decimals shown (0-8), rounded half away from zero
+ * @param separator Thousands separator, '\0' = none
+ * @return length of the formatted text (truncated to size - 1)
+ */
+size_t formatPrice(char *buffer, size_t size, Price price, int digits, char separator) {
+    if (size == 0) {
+        return 0;
+    }
+    digits = constrain(digits, 0, PRICE_DECIMALS);
+
+    bool negative = price < 0;
+    uint64_t value = negative ? -(uint64_t)price : (uint64_t)price;
+    uint64_t divisor = powers_of_ten[PRICE_DECIMALS - digits];
+    value = (value + divisor / 2) / divisor;
+    uint64_t integer = value / powers_of_ten[digits];
+    uint32_t fraction = (uint32_t)(value - integer * powers_of_ten[digits]);
+
+    char text[PRICE_TEXT_SIZE + 8];
+    char *p = text + sizeof(text);
+    for (int i = 0; i < digits; i++) {
+        *--p = '0' + fraction % 10;
+        fraction /= 10;
+    }
+    if (digits > 0) {
+        *--p = '.';
+    }
+
+    int group = 0;
+    auto putDigit = [&](char digit) {
+        if (separator != '\0' && group++ == 3) {
+            *--p = separator;
+            group = 1;
+        }
+        *--p = digit;
+    };
+    while (integer > UINT32_MAX) {
+        putDigit('0' + integer % 10);
+        integer /= 10;
+    }
+    uint32_t small = (uint32_t)integer;
+    do {
+        putDigit('0' + small % 10);
+        small /= 10;
+    } while (small > 0);
+    if (negative) {
+        *--p = '-';
+    }
+
+    size_t len = min((size_t)(text + sizeof(text) - p), size - 1);
+    memcpy(buffer, p, len);
+    buffer[len] = '\0';
+    return len;
+}
+
+// ====================================================================================================
+// Benchmark (build flag PRICE_BENCHMARK) =============================================================
+// ====================================================================================================
+#ifdef PRICE_BENCHMARK
+
+#define PRICE_BENCHMARK_LOOPS 20000
+
+/**
+ * Compares formatPrice() with the snprintf() path it replaced, results go to the serial log
+ */
+void benchmarkPriceFormat() {
+    static const Price samples[] = { 6012345678900LL, 345678000000LL, 263712345678LL, 3112345678LL, 12345LL };
+    static const int sample_digits[] = { 2, 2, 2, 3, 8 };
+    const int count = sizeof(samples) / sizeof(samples[0]);
+
+    float float_samples[count];
+    for (int i = 0; i < count; i++) {
+        float_samples[i] = priceToFloat(samples[i]);
+    }
+
+    char text[PRICE_TEXT_SIZE];
+    char fmt[10];
+    volatile size_t sink = 0;
+
+    ulong start = micros();
+    for (int n = 0; n < PRICE_BENCHMARK_LOOPS; n++) {
+        int i = n % count;
+        snprintf(fmt, sizeof(fmt), "%%.%df", sample_digits[i]);
+        sink += snprintf(text, sizeof(text), fmt, float_samples[i]);
+    }
+    ulong snprintf_us = micros() - start;
+
+    start = micros();
+    for (int n = 0; n < PRICE_BENCHMARK_LOOPS; n++) {
+        int i = n % count;
+        sink += formatPrice(text, sizeof(text), samples[i], sample_digits[i], '\0');
+    }
+    ulong format_us = micros() - start;
+
+    start = micros();
+    for (int n = 0; n < PRICE_BENCHMARK_LOOPS; n++) {
+        int i = n % count;
+        sink += formatPrice(text, sizeof(text), samples[i], sample_digits[i], ',');
+    }
+    ulong separator_us = micros() - start;
+
+    LOG_SINFO("Price format benchmark (%d calls): snprintf %lu ns, formatPrice %lu ns, with separator %lu ns per call",
+              PRICE_BENCHMARK_LOOPS, snprintf_us * 1000UL / PRICE_BENCHMARK_LOOPS,
+              format_us * 1000UL / PRICE_BENCHMARK_LOOPS, separator_us * 1000UL / PRICE_BENCHMARK_LOOPS);
+    LOG_SINFO("Price format benchmark: formatPrice is %.1fx faster (%u)",
+              (float)snprintf_us / max(format_us, 1UL), (unsigned)sink);
+}
+
+#endif
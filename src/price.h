@@ -0,0 +1,38 @@
+#ifndef PRICE_H
+#define PRICE_H
+
+#include <Arduino.h>
+
+// Prices are scaled 64-bit integers from parse to display, the history stores keep their own
+// fixed-point format (see history.h)
+typedef int64_t Price;
+
+#define PRICE_DECIMALS       8
+#define PRICE_SCALE          100000000LL     // 10^PRICE_DECIMALS
+#define PRICE_INT_DIGITS     10              // max. integer digits accepted by the parser
+#define PRICE_TEXT_SIZE      24              // enough for any formatted price incl. separators
+
+// Derivatives data delivered in the same payload as the index price (premiumIndex, mark price stream)
+struct MarketInfo {
+    Price mark_price;           // 0 = not received
+    float funding_rate;         // last funding rate, 0.0001 = 0.01 %
+    uint32_t next_funding;      // unix time (s) of the next funding, 0 = unknown
+};
+
+bool parseDecimalPrice(const char *text, Price &price);
+bool parseMarketInfo(const char *mark_price, const char *funding_rate, uint64_t next_funding_ms, MarketInfo &info);
+size_t formatPrice(char *buffer, size_t size, Price price, int digits, char separator);
+
+inline float priceToFloat(Price price) {
+    return (float)((double)price / PRICE_SCALE);
+}
+
+inline Price priceFromFloat(double value) {
+    return (Price)(value * PRICE_SCALE + (value < 0 ? -0.5 : 0.5));
+}
+
+#ifdef PRICE_BENCHMARK
+void benchmarkPriceFormat();
+#endif
+
+#endif // PRICE_H
@@ -0,0 +1,144 @@
+#include "globals.h"
+#include "display.h"
+#include "pricestream.h"
+#include <WebSocketsClient.h>
+
+static WebSocketsClient ws;
+static bool stream_connected = false;
+static bool tick_received = false;     // a tick arrived on the current connection, else last_tick is invalid
+static ulong last_tick = 0;
+static int tick_count = 0;
+static Price tick_prices[MAX_ASSETS];   // ticks since the last handlePriceStream() call
+static MarketInfo tick_infos[MAX_ASSETS];
+
+/**
+ * Parses a combined stream mark price message and stores index price, mark price and funding of the matching asset
+ * {"stream":"btcusdt@markPrice@1s","data":{"e":"markPriceUpdate","s":"BTCUSDT","p":"...","i":"...","r":"...","T":...}}
+ */
+static void parseTick(const uint8_t *payload, size_t length) {
+    JsonDocument filter;
+    filter["data"]["s"] = true;
+    filter["data"]["i"] = true;
+    filter["data"]["p"] = true;
+    filter["data"]["r"] = true;
+    filter["data"]["T"] = true;
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, payload, length, DeserializationOption::Filter(filter));
+    if (error) {
+        LOG_SERROR("JSON parse failed for stream tick: %s", error.c_str());
+        return;
+    }
+
+    const char* symbol = doc["data"]["s"];
+    if (symbol == nullptr) {
+        return;
+    }
+
+    // index price, same value as indexPrice of the premiumIndex request
+    Price price = 0;
+    if (!parseDecimalPrice(doc["data"]["i"].as<const char*>(), price) || price <= 0) {
+        LOG_SERROR("Invalid stream price for %s", symbol);
+        return;
+    }
+
+    MarketInfo info;
+    parseMarketInfo(doc["data"]["p"].as<const char*>(), doc["data"]["r"].as<const char*>(),
+                    doc["data"]["T"].as<uint64_t>(), info);
+
+    for (int i = 0; i < num_fetched; i++) {
+        if (strcasecmp(symbol, assets[i].symbol) == 0) {
+            tick_prices[i] = price;
+            tick_infos[i] = info;
+            last_tick = TIMENOW;
+            tick_received = true;
+            tick_count++;
+        }
+    }
+}
+
+static void onStreamEvent(WStype_t type, uint8_t *payload, size_t length) {
+    switch (type) {
+        case WStype_CONNECTED:
+            LOG_SINFO("Price stream connected");
+            stream_connected = true;
+            tick_received = false;
+            break;
+        case WStype_DISCONNECTED:
+            if (stream_connected) {
+                LOG_SINFO("Price stream disconnected, fallback to polling");
+            }
+            stream_connected = false;
+            tick_received = false;
+            break;
+        case WStype_TEXT:
+            parseTick(payload, length);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Subscribes to the mark price stream of all configured symbols
+ * PRICE_STREAM_HOST/PORT/TLS can be set as build flags to use a local stand-in server.
+ */
+void initPriceStream() {
+    if (!dc.stream_enabled) {
+        return;
+    }
+
+    // "/stream?streams=btcusdt@markPrice@1s/ethusdt@markPrice@1s/..."
+    static char path[PRICE_STREAM_PATH_SIZE];
+    int len = snprintf(path, sizeof(path), "/stream?streams=");
+    for (int i = 0; i < num_fetched && len < (int)sizeof(path); i++) {
+        len += snprintf(path + len, sizeof(path) - len, "%s", (i > 0) ? "/" : "");
+        for (const char *c = assets[i].symbol; *c && len < (int)sizeof(path) - 1; c++) {
+            path[len++] = tolower(*c);
+        }
+        path[len] = '\0';
+        len += snprintf(path + len, sizeof(path) - len, "@markPrice@1s");
+    }
+    LOG_SINFO("Price stream: %s:%d%s", PRICE_STREAM_HOST, PRICE_STREAM_PORT, path);
+
+#if PRICE_STREAM_TLS
+    ws.beginSSL(PRICE_STREAM_HOST, PRICE_STREAM_PORT, path);
+#else
+    ws.begin(PRICE_STREAM_HOST, PRICE_STREAM_PORT, path);
+#endif
+    ws.onEvent(onStreamEvent);
+    ws.setReconnectInterval(PRICE_STREAM_RECONNECT);
+    ws.enableHeartbeat(15000, 3000, 2);
+}
+
+/**
+ * Processes pending stream messages, reconnects automatically
+ *
+ * @param prices Output array of num_assets prices received since the last call, 0 = no tick
+ * @param infos  Output array of num_assets market infos received since the last call, mark_price 0 = no tick
+ * @return number of ticks received since the last call
+ */
+int handlePriceStream(Price *prices, MarketInfo *infos) {
+    if (!dc.stream_enabled) {
+        return 0;
+    }
+    tick_count = 0;
+    for (int i = 0; i < num_assets; i++) {
+        tick_prices[i] = 0;
+        tick_infos[i] = {};
+    }
+    ws.loop();
+    memcpy(prices, tick_prices, sizeof(tick_prices));
+    memcpy(infos, tick_infos, sizeof(tick_infos));
+    return tick_count;
+}
+
+
+/**
+ * @return true if the stream is connected and delivers ticks, false if polling has to be used
+ * A connection without any tick yet is not active, polling continues until the first tick arrives.
+ */
+bool isPriceStreamActive() {
+    return dc.stream_enabled && stream_connected && tick_received
+        && (ulong)(TIMENOW - last_tick) < PRICE_STREAM_STALE;
+}
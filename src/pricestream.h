@@ -0,0 +1,15 @@
+#ifndef PRICESTREAM_H
+#define PRICESTREAM_H
+
+#include "price.h"
+
+// Stream is considered down if no tick arrived within this time (ms), polling takes over
+#define PRICE_STREAM_STALE      15000
+#define PRICE_STREAM_RECONNECT  5000
+#define PRICE_STREAM_PATH_SIZE  512
+
+void initPriceStream();
+int handlePriceStream(Price *prices, MarketInfo *infos);
+bool isPriceStreamActive();
+
+#endif // PRICESTREAM_H
@@ -0,0 +1,201 @@
+#include "globals.h"
+#include "display.h"
+#include "crypto.h"
+#include "alerts.h"
+#include "render.h"
+#include <sys/time.h>
+
+#define MAX_Y 45
+#define MOVE_Y 5
+
+// Timer (render task only)
+static ulong last_rotation = 0;
+static ulong last_shift = 0;
+static time_t last_second = 0;
+
+// Hardware shift of the whole image (anti-burn-in protection)
+static int y_offset = 0;
+static int bounce_direction_y = 1;
+
+// Current asset
+static int current_asset = 0;
+
+// Fired alert, the asset flashes and the rotation pauses until alert_until
+static bool alert_active = false;
+static ulong alert_until = 0;
+static ulong last_blink = 0;
+static bool blink_inverted = false;
+
+/**
+ * Moves the image step rows up or down within the bounce range, reverses at both ends
+ */
+static void shiftDisplay(int step) {
+    int max_y = MAX_Y - infoRowsHeight();
+    y_offset = constrain(y_offset + bounce_direction_y * step, 0, max_y);
+    if (y_offset >= max_y) {
+        bounce_direction_y = -1;
+    } else if (y_offset <= 0) {
+        bounce_direction_y = 1;
+    }
+    setDisplayOffset(y_offset);
+}
+
+/**
+ * Draws the current asset, the bounce is applied by the panel
+ *
+ * @param lag_us Delay of the frame behind its due time
+ */
+static void showCurrentAsset(uint32_t lag_us) {
+    beginFrame(lag_us);
+    AssetData& asset = assets[current_asset];
+    displayAsset(asset.asset_name, asset.current_price, getOldPrice(current_asset),
+                 asset.digits, asset.change_percent, asset.window_minutes, dc.x_offset);
+    displayChangeWindows(asset, dc.x_offset);
+    displayStats(asset, dc.x_offset);
+    displayMarketInfo(asset, dc.x_offset);
+
+    displayDateTime();
+    endFrame(FRAME_ASSET);
+}
+
+/**
+ * Redraws the clock once per wall-clock second
+ * During a transition the clock is drawn into the composed frame and shown by the next transition frame.
+ *
+ * @return ms until the next second starts
+ */
+static uint32_t updateClock() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (tv.tv_sec != last_second) {
+        // the lag is the time behind the second boundary
+        beginFrame(tv.tv_usec);
+        displayDateTime();
+        endFrame(FRAME_CLOCK);
+        last_second = tv.tv_sec;
+    }
+    return (1000000 - tv.tv_usec) / 1000 + 1;
+}
+
+/**
+ * Plays the pending transition at RENDER_FRAME_TIME per frame until it reaches the composed frame
+ * Progress follows the elapsed time, a late frame catches up instead of stretching the transition.
+ * The clock keeps ticking on the second boundaries meanwhile.
+ */
+static void playTransition() {
+    ulong start = TIMENOW;
+    TickType_t wake = xTaskGetTickCount();
+    for (uint32_t frame = 0; isTransitionPending(); frame++) {
+        updateClock();
+        ulong now = TIMENOW;
+        ulong due = start + frame * RENDER_FRAME_TIME;
+        uint32_t lag_us = ((long)(now - due) > 0) ? (now - due) * 1000UL : 0;
+        renderTransition((float)(now - start) / dc.transition_ms, lag_us);
+        if (isTransitionPending()) {
+            vTaskDelayUntil(&wake, pdMS_TO_TICKS(RENDER_FRAME_TIME));
+        }
+    }
+}
+
+/**
+ * Applies new prices and fires alerts, an alert shows its asset with a hard cut and flashes it
+ */
+static void updatePrices(ulong now) {
+    // Apply prices published by the fetch task (never blocks on network I/O)
+    if (applyPriceSnapshots() == 0) {
+        return;
+    }
+    // Calculate percentage change on each update
+    calculateChanges();
+
+    // A fired alert interrupts the rotation and shows its asset
+    int alert_asset = checkAlerts();
+    if (alert_asset >= 0) {
+        current_asset = alert_asset;
+        alert_active = true;
+        alert_until = now + (ulong)dc.alert_flash * 1000UL;
+        last_blink = now;
+        last_rotation = now;
+        showCurrentAsset(0);
+    }
+}
+
+/**
+ * Alert flash, inverting the display needs no redraw
+ */
+static void updateAlertFlash(ulong now) {
+    if (!alert_active) {
+        return;
+    }
+    if ((long)(now - alert_until) >= 0) {
+        alert_active = false;
+        blink_inverted = false;
+        tft.invertDisplay(false);
+    } else if ((ulong)(now - last_blink) >= ALERT_BLINK) {
+        blink_inverted = !blink_inverted;
+        tft.invertDisplay(blink_inverted);
+        last_blink = now;
+    }
+    last_rotation = now;
+}
+
+/**
+ * Shows the next asset when the display time is over, as transition if one is configured
+ */
+static void updateRotation(ulong now) {
+    ulong display_ms = (ulong)dc.display_time * 1000UL;
+    if ((ulong)(now - last_rotation) < display_ms) {
+        return;
+    }
+    uint32_t lag_us = (now - last_rotation - display_ms) * 1000UL;
+    current_asset = (current_asset + 1) % num_assets;
+    last_rotation = now;
+
+    // Display current asset, with transition the frame is composed off-screen and played afterwards
+    beginTransition();
+    showCurrentAsset(lag_us);
+
+    // Y-offset bouncing with each asset, unless it drifts on its own timer. After the capture, so the
+    // shown frame does not jump before a transition starts, the shift comes with its first frame.
+    if (dc.shift_interval == 0) {
+        shiftDisplay(MOVE_Y);
+    }
+}
+
+/**
+ * Render task: owns the display, wakes at each second boundary for the clock and at least every
+ * RENDER_IDLE_TICK for prices, alerts and the rotation
+ */
+static void renderTask(void *param) {
+    for (;;) {
+        ulong now = TIMENOW;
+        updatePrices(now);
+        updateAlertFlash(now);
+        updateRotation(now);
+        if (isTransitionPending()) {
+            playTransition();
+            continue;
+        }
+
+        // Slow drift, one row per shift interval (a single command to the panel)
+        if (dc.shift_interval > 0 && (ulong)(now - last_shift) >= (ulong)dc.shift_interval * 1000UL) {
+            shiftDisplay(1);
+            last_shift = now;
+        }
+
+        uint32_t next_second = updateClock();
+        vTaskDelay(pdMS_TO_TICKS(min(next_second, (uint32_t)RENDER_IDLE_TICK)));
+    }
+}
+
+/**
+ * Starts the render task, call after initDisplay()
+ * From here on the display is drawn by the render task only.
+ */
+void initRender() {
+    last_rotation = TIMENOW;
+    last_shift = TIMENOW;
+    last_second = time(nullptr);
+    xTaskCreatePinnedToCore(renderTask, "render", RENDER_TASK_STACK, nullptr, RENDER_TASK_PRIORITY, nullptr,
+                            RENDER_TASK_CORE);
+}
@@ -0,0 +1,13 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+// Render task on core 1, next to loop() which keeps WiFi, NTP and the web server
+#define RENDER_TASK_CORE      1
+#define RENDER_TASK_STACK     8192
+#define RENDER_TASK_PRIORITY  2       // above loop(), a frame is never delayed by it
+#define RENDER_IDLE_TICK      50      // ms, max. sleep between checks for prices, alerts and rotation
+#define RENDER_FRAME_TIME     33      // ms per transition frame (30 fps)
+
+void initRender();
+
+#endif // RENDER_H
@@ -0,0 +1,229 @@
+#include "globals.h"
+#include "display.h"
+#include "scheduler.h"
+
+// fetch task only
+static ulong next_fetch[MAX_ASSETS];
+
+// poll-to-poll changes, variance in %^2 per ms (fetch task only)
+static Price last_poll_price[MAX_ASSETS];
+static ulong last_poll_time[MAX_ASSETS];
+static float variance_rate[MAX_ASSETS];
+static uint16_t vol_polls[MAX_ASSETS];
+static float request_tokens = 0.0f;
+static ulong last_refill = 0;
+
+// request governor, fed with the rate limit headers (fetch task only)
+static uint32_t used_weight = 0;
+static uint32_t weight_minute = 0;
+static ulong blocked_until = 0;
+static bool blocked = false;
+
+void initScheduler() {
+    for (int i = 0; i < num_assets; i++) {
+        last_poll_price[i] = 0;
+        variance_rate[i] = 0.0f;
+        vol_polls[i] = 0;
+        next_fetch[i] = TIMENOW;
+    }
+    request_tokens = dc.poll_budget;
+    last_refill = TIMENOW;
+}
+
+/**
+ * Feeds a polled price into the volatility estimate of an asset (fetch task only)
+ * The squared change since the previous poll divided by the elapsed time is averaged over about
+ * VOL_SAMPLES polls. Normalized by time, a rarely polled asset measures the same volatility as a
+ * frequently polled one, so backing off does not make it look quieter.
+ */
+void recordPoll(int asset_index, Price price, ulong now) {
+    if (price <= 0) {
+        return;
+    }
+    Price previous = last_poll_price[asset_index];
+    ulong elapsed = now - last_poll_time[asset_index];
+    last_poll_price[asset_index] = price;
+    last_poll_time[asset_index] = now;
+    if (previous <= 0 || elapsed == 0) {
+        return;
+    }
+
+    float change = (float)(price - previous) / (float)previous * 100.0f;
+    float rate = change * change / elapsed;
+    uint16_t n = (vol_polls[asset_index] < VOL_SAMPLES) ? ++vol_polls[asset_index] : VOL_SAMPLES;
+    variance_rate[asset_index] += (rate - variance_rate[asset_index]) / n;
+}
+
+/**
+ * @return volatility of an asset in % per price_update interval, 0 before VOL_MIN_POLLS changes
+ */
+float getVolatility(int asset_index) {
+    if (vol_polls[asset_index] < VOL_MIN_POLLS) {
+        return 0.0f;
+    }
+    return sqrtf(variance_rate[asset_index] * dc.price_update * 60000.0f);
+}
+
+/**
+ * Poll interval of an asset in ms
+ * Assets at VOL_REFERENCE are polled every price_update minutes, more volatile ones
+ * proportionally more often (down to poll_min seconds), quiet ones back off. Without enough
+ * polls for an estimate yet, the asset is polled at the base interval.
+ */
+ulong getPollInterval(int asset_index) {
+    ulong base = (ulong)dc.price_update * 60000UL;
+    if (!dc.adaptive_poll) {
+        return base;
+    }
+
+    ulong min_interval = (ulong)dc.poll_min * 1000UL;
+    ulong max_interval = base * POLL_MAX_FACTOR;
+    if (vol_polls[asset_index] < VOL_MIN_POLLS) {
+        return base;
+    }
+    float vol = getVolatility(asset_index);
+    if (vol <= 0.0f) {
+        return max_interval;
+    }
+
+    float interval = base * (VOL_REFERENCE / vol);
+    if (interval < min_interval) {
+        return min_interval;
+    }
+    if (interval > max_interval) {
+        return max_interval;
+    }
+    return (ulong)interval;
+}
+
+/**
+ * @return index of the most overdue asset, -1 if no asset is due
+ */
+int getDueAsset(ulong now) {
+    int due = -1;
+    long max_overdue = -1;
+    for (int i = 0; i < num_fetched; i++) {
+        long overdue = (long)(now - next_fetch[i]);
+        if (overdue >= 0 && overdue > max_overdue) {
+            max_overdue = overdue;
+            due = i;
+        }
+    }
+    return due;
+}
+
+void scheduleNext(int asset_index, ulong now) {
+    next_fetch[asset_index] = now + getPollInterval(asset_index);
+}
+
+// after a batch request, all assets are fresh
+void scheduleAll(ulong now) {
+    for (int i = 0; i < num_fetched; i++) {
+        scheduleNext(i, now);
+    }
+}
+
+// e.g. until an open circuit breaker allows the next probe
+void deferUntil(int asset_index, ulong time) {
+    if ((long)(time - next_fetch[asset_index]) > 0) {
+        next_fetch[asset_index] = time;
+    }
+}
+
+/**
+ * Minute of the exchange weight window, wall clock if NTP is synced
+ */
+static uint32_t currentMinute(ulong now) {
+    time_t t = time(nullptr);
+    return (t > 1600000000) ? (uint32_t)(t / 60) : (uint32_t)(now / 60000UL);
+}
+
+static void rollWeightWindow(ulong now) {
+    uint32_t minute = currentMinute(now);
+    if (minute != weight_minute) {
+        weight_minute = minute;
+        used_weight = 0;
+    }
+}
+
+/**
+ * Request governor: defers requests while a Retry-After is pending or the weight of the
+ * current minute would exceed RATE_LIMIT_HEADROOM
+ */
+static bool governorAllows(uint16_t weight, ulong now) {
+    if (blocked) {
+        if ((long)(now - blocked_until) < 0) {
+            return false;
+        }
+        blocked = false;
+    }
+    rollWeightWindow(now);
+    return (used_weight + weight) * 100 <= (uint32_t)RATE_LIMIT_WEIGHT * RATE_LIMIT_HEADROOM;
+}
+
+/**
+ * Global request budget (token bucket, refilled with poll_budget requests per minute)
+ * The refill rate drops linearly from RATE_LIMIT_THROTTLE to RATE_LIMIT_HEADROOM of the weight limit.
+ *
+ * @param weight Request weight of the exchange
+ * @return true if a request may be sent now
+ */
+bool takeRequestToken(ulong now, uint16_t weight) {
+    if (!governorAllows(weight, now)) {
+        return false;
+    }
+
+    float rate = dc.poll_budget / 60000.0f;
+    float used = used_weight * 100.0f / RATE_LIMIT_WEIGHT;
+    if (used > RATE_LIMIT_THROTTLE) {
+        rate *= (used < RATE_LIMIT_HEADROOM) ? (RATE_LIMIT_HEADROOM - used) / (RATE_LIMIT_HEADROOM - RATE_LIMIT_THROTTLE) : 0.0f;
+    }
+    request_tokens += (now - last_refill) * rate;
+    last_refill = now;
+    if (request_tokens > dc.poll_budget) {
+        request_tokens = dc.poll_budget;
+    }
+
+    if (request_tokens < 1.0f) {
+        return false;
+    }
+    request_tokens -= 1.0f;
+    used_weight += weight;
+    return true;
+}
+
+/**
+ * Updates the governor with the rate limit headers of a response
+ *
+ * @param code        HTTP status code
+ * @param used_weight X-MBX-USED-WEIGHT-1M, -1 if not sent
+ * @param retry_after Retry-After in seconds, 0 if not sent
+ */
+void updateRateLimit(int code, int32_t _used_weight, uint32_t retry_after, ulong now) {
+    rollWeightWindow(now);
+    if (_used_weight >= 0) {
+        // IP wide value, includes the requests of other devices
+        used_weight = _used_weight;
+    }
+
+    // 429 = too many requests, 418 = IP banned
+    if (code == 429 || code == 418 || retry_after > 0) {
+        if (retry_after == 0) {
+            retry_after = RETRY_AFTER_DEFAULT;
+        }
+        blocked = true;
+        blocked_until = now + retry_after * 1000UL;
+        LOG_SERROR("Rate limit hit (HTTP %d), requests deferred for %u s", code, retry_after);
+    }
+}
+
+RateLimitStatus getRateLimitStatus(ulong now) {
+    RateLimitStatus status;
+    uint32_t headroom = (uint32_t)RATE_LIMIT_WEIGHT * RATE_LIMIT_HEADROOM / 100;
+    status.used_weight = used_weight;
+    status.limit = RATE_LIMIT_WEIGHT;
+    status.remaining = (used_weight < headroom) ? headroom - used_weight : 0;
+    status.blocked_ms = (blocked && (long)(blocked_until - now) > 0) ? blocked_until - now : 0;
+    status.tokens = request_tokens;
+    return status;
+}
@@ -0,0 +1,38 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "price.h"
+
+#define VOL_SAMPLES        10       // polls averaged by the volatility estimate
+#define VOL_MIN_POLLS      2        // poll-to-poll changes needed before the interval adapts
+#define VOL_REFERENCE      0.05f    // volatility (% per price_update interval) that is polled at that interval
+#define POLL_MAX_FACTOR    4        // quiet assets back off up to 4 x price_update
+
+// Exchange request weight limit per minute (shared by all devices behind the same IP)
+#define RATE_LIMIT_WEIGHT    2400
+#define RATE_LIMIT_HEADROOM  80       // % of the limit at which requests are deferred to the next minute
+#define RATE_LIMIT_THROTTLE  50       // % of the limit above which the request budget is reduced
+#define RETRY_AFTER_DEFAULT  60       // s, for 429/418 without Retry-After
+
+struct RateLimitStatus {
+    uint16_t used_weight;    // estimated weight used in the current minute
+    uint16_t limit;
+    uint16_t remaining;      // weight left before requests are deferred
+    uint32_t blocked_ms;     // time until requests are allowed again, 0 = not blocked
+    float tokens;            // request budget tokens
+};
+
+void initScheduler();
+void recordPoll(int asset_index, Price price, ulong now);
+float getVolatility(int asset_index);
+ulong getPollInterval(int asset_index);
+int getDueAsset(ulong now);
+void scheduleNext(int asset_index, ulong now);
+void scheduleAll(ulong now);
+void deferUntil(int asset_index, ulong time);
+bool takeRequestToken(ulong now, uint16_t weight);
+void updateRateLimit(int code, int32_t used_weight, uint32_t retry_after, ulong now);
+RateLimitStatus getRateLimitStatus(ulong now);
+
+#endif // SCHEDULER_H
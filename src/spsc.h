@@ -0,0 +1,45 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Lock-free single-producer/single-consumer ring buffer
+ * push() must only be called by one task and pop() only by one other task.
+ * The indices run freely, N has to be a power of two.
+ */
+template <typename T, uint32_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+  public:
+    // Producer side, returns false if the queue is full
+    bool push(const T &item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, returns false if the queue is empty
+    bool pop(T &item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    T items[N];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+};
+
+#endif // SPSC_H
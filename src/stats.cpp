@@ -0,0 +1,188 @@
+#include "globals.h"
+#include "stats.h"
+
+/**
+ * @param window_samples Samples of the history window
+ * @param ema_period     EMA period in samples
+ * @param storage        Deque memory of storageFor(window_samples) bytes, owned by the caller (asset arena)
+ */
+void RollingStats::begin(uint32_t window_samples, uint16_t ema_period, uint16_t *storage) {
+    uint16_t capacity = min(window_samples, (uint32_t)STATS_WINDOW_MAX);
+    max_deque.begin(storage, capacity);
+    min_deque.begin(storage + capacity, capacity);
+    alpha = 2.0f / (ema_period + 1);
+    reset();
+}
+
+/**
+ * Bytes of deque memory for a window, a deque can hold every sample of the window
+ */
+size_t RollingStats::storageFor(uint32_t window_samples) {
+    return 2 * min(window_samples, (uint32_t)STATS_WINDOW_MAX) * sizeof(uint16_t);
+}
+
+void RollingStats::reset() {
+    max_deque.reset();
+    min_deque.reset();
+    sequence = 0;
+    high_value = low_value = 0;
+    price_count = change_count = 0;
+    price_mean = price_m2 = 0.0;
+    change_mean = change_m2 = 0.0;
+    ema_value = 0.0f;
+    newest = oldest = 0.0f;
+    history_size = 0;
+}
+
+/**
+ * Adds the newest history sample, call after every PriceHistory::push()
+ * The sample is taken as stored (quantized), so the value removed when it leaves the window is
+ * exactly the value that was added.
+ *
+ * @param history History the sample was pushed to
+ */
+void RollingStats::update(const PriceHistory &history) {
+    uint32_t size = history.size();
+    if (size == 0) {
+        return;
+    }
+    if (size < history_size || size > history_size + 1) {
+        // the history dropped a block (pool exhausted), the only case that needs a rescan
+        rebuild(history);
+        return;
+    }
+
+    if (size == history_size) {
+        // window full: the previous oldest sample left
+        removePrice(oldest);
+        removeChange(oldest, priceToFloat(history.oldest()));
+    }
+    addSample(history, size - 1, size);
+    oldest = priceToFloat(history.oldest());
+    history_size = size;
+}
+
+float RollingStats::stddev() const {
+    return (price_count > 1) ? sqrt(price_m2 / (price_count - 1)) : 0.0f;
+}
+
+/**
+ * @return standard deviation of the sample to sample change in percent
+ */
+float RollingStats::volatility() const {
+    return (change_count > 1) ? sqrt(change_m2 / (change_count - 1)) : 0.0f;
+}
+
+/**
+ * @param history History holding the sample
+ * @param index   Index of the sample in the history, the newest sample added so far
+ * @param size    Samples of the window up to this one
+ */
+void RollingStats::addSample(const PriceHistory &history, uint32_t index, uint32_t size) {
+    Price sample = history.get(index);
+    float price = priceToFloat(sample);
+    addPrice(price);
+    addChange(newest, price);
+    newest = price;
+    sequence++;
+
+    if (price > 0.0f) {
+        ema_value = (ema_value == 0.0f) ? price : ema_value + alpha * (price - ema_value);
+    }
+    updateExtremes(history, index, size, sample);
+}
+
+/**
+ * Pushes the sample to the min/max deques and drops the samples that left the window
+ * Samples without a price (0) are not pushed.
+ */
+void RollingStats::updateExtremes(const PriceHistory &history, uint32_t index, uint32_t size, Price price) {
+    // the window is shorter than 2^16 samples, so the 16-bit distance to the current sample is exact
+    uint16_t current = (uint16_t)(sequence - 1);
+    auto valueOf = [&](uint16_t sample) { return history.get(index - (uint16_t)(current - sample)); };
+
+    // expire first, the deques then never hold more than the window
+    while (!max_deque.empty() && (uint16_t)(current - max_deque.front()) >= size) {
+        max_deque.popFront();
+    }
+    while (!min_deque.empty() && (uint16_t)(current - min_deque.front()) >= size) {
+        min_deque.popFront();
+    }
+
+    // samples at the back that can never be the extreme again are dropped
+    if (price > 0) {
+        while (!max_deque.empty() && valueOf(max_deque.back()) <= price) {
+            max_deque.popBack();
+        }
+        max_deque.pushBack(current);
+        while (!min_deque.empty() && valueOf(min_deque.back()) >= price) {
+            min_deque.popBack();
+        }
+        min_deque.pushBack(current);
+    }
+
+    high_value = max_deque.empty() ? 0 : valueOf(max_deque.front());
+    low_value = min_deque.empty() ? 0 : valueOf(min_deque.front());
+}
+
+/**
+ * Recomputes all statistics from the history
+ */
+void RollingStats::rebuild(const PriceHistory &history) {
+    uint32_t size = history.size();
+    reset();
+    for (uint32_t i = 0; i < size; i++) {
+        addSample(history, i, i + 1);
+    }
+    oldest = priceToFloat(history.oldest());
+    history_size = size;
+}
+
+// Welford update, zero prices (no price yet) are not counted
+void RollingStats::addPrice(float price) {
+    if (price <= 0.0f) {
+        return;
+    }
+    price_count++;
+    double delta = price - price_mean;
+    price_mean += delta / price_count;
+    price_m2 += delta * (price - price_mean);
+}
+
+void RollingStats::removePrice(float price) {
+    if (price <= 0.0f || price_count == 0) {
+        return;
+    }
+    if (--price_count == 0) {
+        price_mean = price_m2 = 0.0;
+        return;
+    }
+    double delta = price - price_mean;
+    price_mean -= delta / price_count;
+    price_m2 = max(0.0, price_m2 - delta * (price - price_mean));
+}
+
+void RollingStats::addChange(float from, float to) {
+    if (from <= 0.0f || to <= 0.0f) {
+        return;
+    }
+    double change = (to - from) / from * 100.0;
+    change_count++;
+    double delta = change - change_mean;
+    change_mean += delta / change_count;
+    change_m2 += delta * (change - change_mean);
+}
+
+void RollingStats::removeChange(float from, float to) {
+    if (from <= 0.0f || to <= 0.0f || change_count == 0) {
+        return;
+    }
+    double change = (to - from) / from * 100.0;
+    if (--change_count == 0) {
+        change_mean = change_m2 = 0.0;
+        return;
+    }
+    double delta = change - change_mean;
+    change_mean -= delta / change_count;
+    change_m2 = max(0.0, change_m2 - delta * (change - change_mean));
+}
@@ -0,0 +1,85 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <Arduino.h>
+#include "history.h"
+
+#define STATS_WINDOW_MAX   UINT16_MAX     // samples, the deques keep 16-bit sample numbers
+
+/**
+ * Monotonic deque of sample numbers in a ring of caller-owned memory
+ * Only the low 16 bits of the sample numbers are kept, the values are read back from the history, so
+ * an entry costs 2 bytes. The front holds the sample with the max (or min) value of the window.
+ */
+class MonotonicDeque {
+  public:
+    void begin(uint16_t *storage, uint16_t _capacity) { entries = storage; capacity = _capacity; reset(); }
+    void reset() { head = 0; count = 0; }
+    bool empty() const { return count == 0; }
+    uint16_t front() const { return entries[head]; }
+    uint16_t back() const { return entries[(head + count - 1) % capacity]; }
+    void popFront() { head = (head + 1) % capacity; count--; }
+    void popBack() { count--; }
+    void pushBack(uint16_t sample) { entries[(head + count) % capacity] = sample; count++; }
+
+  private:
+    uint16_t *entries = nullptr;
+    uint16_t capacity = 0;
+    uint16_t head = 0;
+    uint16_t count = 0;
+};
+
+/**
+ * Rolling statistics of the history window, updated in constant time per sample (amortized)
+ * - high/low: exact, monotonic deques over the samples of the window, sized for the whole window
+ * - mean/stddev of the price and volatility (stddev of the sample to sample change in %):
+ *   Welford update with removal of the sample that left the window
+ * - EMA of the price with a configurable period in samples
+ */
+class RollingStats {
+  public:
+    void begin(uint32_t window_samples, uint16_t ema_period, uint16_t *storage);
+    void update(const PriceHistory &history);
+
+    Price high() const { return high_value; }
+    Price low() const { return low_value; }
+    float mean() const { return (float)price_mean; }
+    float stddev() const;
+    float volatility() const;
+    float ema() const { return ema_value; }
+
+    static size_t storageFor(uint32_t window_samples);
+
+  private:
+    MonotonicDeque max_deque;
+    MonotonicDeque min_deque;
+    uint32_t sequence = 0;          // samples added
+    Price high_value = 0;
+    Price low_value = 0;
+
+    // Welford accumulators
+    uint32_t price_count = 0;
+    double price_mean = 0.0;
+    double price_m2 = 0.0;
+    uint32_t change_count = 0;
+    double change_mean = 0.0;
+    double change_m2 = 0.0;
+
+    float alpha = 0.0f;
+    float ema_value = 0.0f;
+
+    float newest = 0.0f;            // newest sample
+    float oldest = 0.0f;            // oldest sample of the window at the last update
+    uint32_t history_size = 0;
+
+    void addSample(const PriceHistory &history, uint32_t index, uint32_t size);
+    void updateExtremes(const PriceHistory &history, uint32_t index, uint32_t size, Price price);
+    void addPrice(float price);
+    void removePrice(float price);
+    void addChange(float from, float to);
+    void removeChange(float from, float to);
+    void reset();
+    void rebuild(const PriceHistory &history);
+};
+
+#endif // STATS_H
@@ -1,5 +1,6 @@
 #include "globals.h"
 #include "storage.h"
+#include "historylog.h"
 
 
 // ====================================================================================================
@@ -37,6 +38,8 @@ void cbSave(int params_count) {
 
 void cbDone() {
     LOG_SINFO("reboot");
+    // keep the buffered history samples across the restart
+    flushHistoryLog();
     delay(10);
     ESP.restart();
 }
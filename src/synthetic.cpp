@@ -0,0 +1,202 @@
+#include "globals.h"
+#include "display.h"
+#include "synthetic.h"
+
+static SyntheticAsset synthetics[SYNTHETIC_MAX];
+static int num_synthetics = 0;
+
+static int precedence(char op) {
+    return (op == '*' || op == '/') ? 2 : (op == '+' || op == '-') ? 1 : 0;
+}
+
+static SyntheticOp operatorOp(char op) {
+    switch (op) {
+        case '+': return SYNTHETIC_ADD;
+        case '-': return SYNTHETIC_SUB;
+        case '*': return SYNTHETIC_MUL;
+        default:  return SYNTHETIC_DIV;
+    }
+}
+
+void resetSynthetics() {
+    num_synthetics = 0;
+}
+
+/**
+ * Compiles an expression over fetched symbols, e.g. "XAUUSDT/XAGUSDT" or "BTCUSDT/EURUSDT"
+ * Operators + - * / with the usual precedence, parentheses and decimal constants (shunting-yard).
+ *
+ * @param asset_index Index of the synthetic asset
+ * @param expression  Expression, symbols are matched case-insensitive
+ * @param legs        Number of fetched assets, legs are looked up in assets[0 .. legs - 1]
+ * @return false if the expression is invalid or too long
+ */
+bool addSyntheticAsset(int asset_index, const char *expression, int legs) {
+    if (num_synthetics >= SYNTHETIC_MAX) {
+        LOG_SERROR("Too many synthetic assets (max. %d)", SYNTHETIC_MAX);
+        return false;
+    }
+
+    SyntheticAsset &synthetic = synthetics[num_synthetics];
+    synthetic.asset = asset_index;
+    synthetic.count = 0;
+
+    char ops[SYNTHETIC_TOKENS];
+    int op_count = 0;
+    int depth = 0;
+    bool expect_operand = true;
+
+    // emits an operator token, two operands become one
+    auto emitOperator = [&](char op) -> bool {
+        if (synthetic.count >= SYNTHETIC_TOKENS) {
+            return false;
+        }
+        synthetic.tokens[synthetic.count++] = { operatorOp(op), 0, 0.0 };
+        depth--;
+        return true;
+    };
+    auto emitOperand = [&](SyntheticOp op, uint8_t leg, double value) -> bool {
+        if (synthetic.count >= SYNTHETIC_TOKENS || ++depth > SYNTHETIC_STACK) {
+            return false;
+        }
+        synthetic.tokens[synthetic.count++] = { op, leg, value };
+        return true;
+    };
+
+    for (const char *c = expression; *c != '\0';) {
+        // symbols may start with a digit (e.g. 1000PEPEUSDT), numbers have no letters
+        bool is_symbol = false;
+        for (const char *end = c; isalnum(*end) || *end == '_'; end++) {
+            is_symbol |= (isalpha(*end) != 0);
+        }
+
+        if (is_symbol) {
+            char symbol[ASSET_SYMBOL_LENGTH];
+            size_t len = 0;
+            for (; isalnum(*c) || *c == '_'; c++) {
+                if (len < sizeof(symbol) - 1) {
+                    symbol[len++] = *c;
+                }
+            }
+            symbol[len] = '\0';
+
+            int leg = -1;
+            for (int i = 0; i < legs && leg < 0; i++) {
+                if (strcasecmp(symbol, assets[i].symbol) == 0) {
+                    leg = i;
+                }
+            }
+            if (!expect_operand || leg < 0) {
+                LOG_SERROR("Synthetic asset: %s is not a fetched symbol", symbol);
+                return false;
+            }
+            if (!emitOperand(SYNTHETIC_LEG, leg, 0.0)) {
+                return false;
+            }
+            expect_operand = false;
+        } else if (isdigit(*c) || *c == '.') {
+            char *end;
+            double value = strtod(c, &end);
+            if (!expect_operand || end == c || !emitOperand(SYNTHETIC_CONST, 0, value)) {
+                return false;
+            }
+            c = end;
+            expect_operand = false;
+        } else if (*c == '(') {
+            if (!expect_operand || op_count >= SYNTHETIC_TOKENS) {
+                return false;
+            }
+            ops[op_count++] = *c++;
+        } else if (*c == ')') {
+            if (expect_operand) {
+                return false;
+            }
+            while (op_count > 0 && ops[op_count - 1] != '(') {
+                if (!emitOperator(ops[--op_count])) {
+                    return false;
+                }
+            }
+            if (op_count == 0) {
+                return false;
+            }
+            op_count--;
+            c++;
+        } else if (precedence(*c) > 0) {
+            if (expect_operand) {
+                return false;
+            }
+            while (op_count > 0 && precedence(ops[op_count - 1]) >= precedence(*c)) {
+                if (!emitOperator(ops[--op_count])) {
+                    return false;
+                }
+            }
+            if (op_count >= SYNTHETIC_TOKENS) {
+                return false;
+            }
+            ops[op_count++] = *c++;
+            expect_operand = true;
+        } else {
+            return false;
+        }
+    }
+
+    if (expect_operand) {
+        return false;
+    }
+    while (op_count > 0) {
+        if (ops[op_count - 1] == '(' || !emitOperator(ops[--op_count])) {
+            return false;
+        }
+    }
+
+    num_synthetics++;
+    return true;
+}
+
+/**
+ * Computes the prices of the synthetic assets from the prices of their legs
+ * Evaluated in double, a missing leg or an invalid result gives 0 (no price).
+ *
+ * @param prices Prices of all assets, the synthetic slots are overwritten
+ */
+void evaluateSynthetics(Price *prices) {
+    for (int s = 0; s < num_synthetics; s++) {
+        const SyntheticAsset &synthetic = synthetics[s];
+        double stack[SYNTHETIC_STACK];
+        int top = 0;
+        bool valid = true;
+
+        for (uint8_t t = 0; t < synthetic.count && valid; t++) {
+            const SyntheticToken &token = synthetic.tokens[t];
+            switch (token.op) {
+                case SYNTHETIC_LEG:
+                    valid = prices[token.leg] > 0;
+                    stack[top++] = (double)prices[token.leg] / PRICE_SCALE;
+                    break;
+                case SYNTHETIC_CONST:
+                    stack[top++] = token.value;
+                    break;
+                case SYNTHETIC_ADD:
+                    top--;
+                    stack[top - 1] += stack[top];
+                    break;
+                case SYNTHETIC_SUB:
+                    top--;
+                    stack[top - 1] -= stack[top];
+                    break;
+                case SYNTHETIC_MUL:
+                    top--;
+                    stack[top - 1] *= stack[top];
+                    break;
+                case SYNTHETIC_DIV:
+                    top--;
+                    valid = stack[top] != 0.0;
+                    stack[top - 1] /= valid ? stack[top] : 1.0;
+                    break;
+            }
+        }
+
+        double result = valid ? stack[0] : 0.0;
+        prices[synthetic.asset] = (result > 0.0 && result < 1e10) ? priceFromFloat(result) : 0;
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include <Arduino.h>
+#include "price.h"
+
+#define SYNTHETIC_MAX       4       // synthetic assets
+#define SYNTHETIC_TOKENS    16      // RPN tokens per expression
+#define SYNTHETIC_STACK     8       // evaluation stack depth
+
+enum SyntheticOp : uint8_t {
+    SYNTHETIC_LEG = 0,              // price of a fetched asset
+    SYNTHETIC_CONST,
+    SYNTHETIC_ADD,
+    SYNTHETIC_SUB,
+    SYNTHETIC_MUL,
+    SYNTHETIC_DIV
+};
+
+struct SyntheticToken {
+    SyntheticOp op;
+    uint8_t leg;                    // asset index of SYNTHETIC_LEG
+    double value;                   // SYNTHETIC_CONST
+};
+
+// Expression compiled to reverse polish notation
+struct SyntheticAsset {
+    uint8_t asset;                  // index of the synthetic asset
+    uint8_t count;
+    SyntheticToken tokens[SYNTHETIC_TOKENS];
+};
+
+void resetSynthetics();
+bool addSyntheticAsset(int asset_index, const char *expression, int legs);
+void evaluateSynthetics(Price *prices);
+
+#endif // SYNTHETIC_H